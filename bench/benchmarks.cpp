@@ -0,0 +1,357 @@
+// Throughput benchmarks. Each workload prints one JSON object per line:
+//
+//     {"workload":"records","mode":"is_valid","documents":...,"nodes":...,
+//      "seconds":...,"documents_per_second":...,"ns_per_node":...,
+//      "allocations_per_validation":...}
+//
+// Each measure runs for at least BENCH_MIN_SECONDS (default 0.5) seconds.
+// The inputs are generated, except for the draft7 test suite, which is read
+// from the same place as in the tests and skipped when it is not there.
+#include "../include/calculisto/json_validator/json_validator.hpp"
+    using namespace calculisto::json_validator;
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <new>
+    namespace fs = std::filesystem;
+    using namespace std::literals;
+    namespace json = tao::json;
+
+// Count the allocations. The operators are not inlined, so that GCC does not
+// take the std::free () in them for a mismatched deallocation.
+    std::atomic <std::size_t>
+allocations { 0 };
+
+    [[gnu::noinline]] void*
+operator new (std::size_t size)
+{
+    allocations.fetch_add (1, std::memory_order_relaxed);
+    if (auto p = std::malloc (size ? size : 1))
+    {
+        return p;
+    }
+    throw std::bad_alloc {};
+}
+
+    [[gnu::noinline]] void
+operator delete (void* p) noexcept
+{
+    std::free (p);
+}
+
+    [[gnu::noinline]] void
+operator delete (void* p, std::size_t) noexcept
+{
+    std::free (p);
+}
+
+    std::size_t
+count_nodes (json::value const& v)
+{
+        std::size_t
+    n = 1;
+    if (v.is_array ())
+    {
+        for (auto&& i: v.get_array ())
+        {
+            n += count_nodes (i);
+        }
+    }
+    if (v.is_object ())
+    {
+        for (auto&& [k, i]: v.get_object ())
+        {
+            n += count_nodes (i);
+        }
+    }
+    return n;
+}
+
+// The validations of one pass over a workload.
+    struct
+case_t
+{
+        const validator_t*
+    validator;
+        json::value
+    instance;
+        std::string
+    schema_uri;
+};
+
+    void
+measure (std::string const& workload, std::vector <case_t> const& cases)
+{
+        const auto
+    min_seconds = std::getenv ("BENCH_MIN_SECONDS")
+        ? std::stod (std::getenv ("BENCH_MIN_SECONDS"))
+        : 0.5;
+    if (cases.empty ())
+    {
+        return;
+    }
+        std::size_t
+    nodes = 0;
+    for (auto&& c: cases)
+    {
+        nodes += count_nodes (c.instance);
+    }
+        const std::pair <const char*, std::function <bool (case_t const&)>>
+    modes[] = {
+          { "validate", [](case_t const& c) { return c.validator->validate (c.instance, c.schema_uri).first; } }
+        , { "is_valid", [](case_t const& c) { return c.validator->is_valid (c.instance, c.schema_uri); } }
+    };
+    for (auto&& [mode, run]: modes)
+    {
+            std::size_t
+        valid = 0;
+        // Warm up.
+        for (auto&& c: cases)
+        {
+            valid += run (c);
+        }
+            std::size_t
+        passes = 0;
+            auto
+        allocations_before = allocations.load ();
+            auto
+        start = std::chrono::steady_clock::now ();
+            std::chrono::duration <double>
+        elapsed;
+        do
+        {
+            for (auto&& c: cases)
+            {
+                valid += run (c);
+            }
+            ++passes;
+            elapsed = std::chrono::steady_clock::now () - start;
+        }
+        while (elapsed.count () < min_seconds);
+            auto
+        validations = static_cast <double> (passes * cases.size ());
+        std::cout << fmt::format (
+              R"({{"workload":"{}","mode":"{}","documents":{},"nodes":{},"valid":{},"seconds":{:.6f},"documents_per_second":{:.1f},"ns_per_node":{:.2f},"allocations_per_validation":{:.2f}}})"
+            , workload
+            , mode
+            , cases.size ()
+            , nodes
+            , valid / (passes + 1)
+            , elapsed.count ()
+            , validations / elapsed.count ()
+            , elapsed.count () * 1e9 / static_cast <double> (passes * nodes)
+            , static_cast <double> (allocations.load () - allocations_before) / validations
+        ) << std::endl;
+    }
+}
+
+// The draft7 test suite, replayed.
+    void
+draft7_suite ()
+{
+        auto const
+    root = fs::path { "../../../external/json-schema-org/" } / "json-schema-test-suite/tests/draft7";
+    if (!fs::exists (root))
+    {
+        std::cerr << "draft7-suite: skipped, " << root.native () << " not found.\n";
+        return;
+    }
+        std::vector <std::unique_ptr <validator_t>>
+    validators;
+        std::vector <case_t>
+    cases;
+    for (auto&& p: fs::directory_iterator (root))
+    {
+        if (!p.is_regular_file () || p.path ().filename () == "refRemote.json")
+        {
+            continue;
+        }
+            const auto
+        test_file = json::from_file (p.path ());
+        for (auto&& test_suite: test_file.get_array ())
+        {
+            try
+            {
+                    auto&
+                validator = validators.emplace_back (std::make_unique <validator_t> ());
+                validator->add_schema (test_suite.at ("schema"), "http://example.com/dummy");
+                for (auto&& test: test_suite.at ("tests").get_array ())
+                {
+                    cases.push_back ({ validator.get (), test.at ("data"), "" });
+                }
+            }
+            catch (std::exception const&)
+            {
+                validators.pop_back ();
+            }
+        }
+    }
+    measure ("draft7-suite", cases);
+}
+
+// A large array of homogeneous records.
+    void
+records (validator_t& validator)
+{
+    validator.add_schema (json::from_string (R"({
+          "type": "array"
+        , "items": {
+              "type": "object"
+            , "required": [ "id", "name", "email", "price", "tags" ]
+            , "additionalProperties": false
+            , "properties": {
+                  "id": { "type": "integer", "minimum": 0 }
+                , "name": { "type": "string", "minLength": 1, "maxLength": 64 }
+                , "email": { "type": "string", "pattern": "^[^@]+@[^@]+$" }
+                , "price": { "type": "number", "exclusiveMinimum": 0, "maximum": 10000 }
+                , "currency": { "enum": [ "EUR", "USD", "GBP", "JPY", "CHF" ] }
+                , "tags": { "type": "array", "items": { "type": "string" }, "uniqueItems": true }
+              }
+          }
+    })"), "http://bench/records");
+        json::value
+    array = json::empty_array;
+    for (int i = 0; i < 10000; ++i)
+    {
+        array.push_back ({
+              { "id", i }
+            , { "name", fmt::format ("record {}", i) }
+            , { "email", fmt::format ("user{}@example.com", i) }
+            , { "price", 1.5 * (i % 1000 + 1) }
+            , { "currency", i % 2 ? "EUR" : "USD" }
+            , { "tags", json::value::array_t { "a", "b", fmt::format ("t{}", i % 7) } }
+        });
+    }
+    measure ("records", { { &validator, array, "http://bench/records" } });
+    // One record in ten is invalid.
+    for (std::size_t i = 0; i < array.get_array ().size (); i += 10)
+    {
+        array.get_array ()[i].get_object ()["price"] = -1;
+    }
+    measure ("records-invalid", { { &validator, array, "http://bench/records" } });
+}
+
+// Deeply nested recursive references.
+    void
+recursive_ref (validator_t& validator)
+{
+    validator.add_schema (json::from_string (R"({
+          "$ref": "#/definitions/node"
+        , "definitions": {
+              "node": {
+                  "type": "object"
+                , "required": [ "value" ]
+                , "properties": {
+                      "value": { "$ref": "#/definitions/value" }
+                    , "children": { "type": "array", "items": { "$ref": "#/definitions/node" } }
+                  }
+              }
+            , "value": { "anyOf": [ { "type": "integer" }, { "type": "string" } ] }
+          }
+    })"), "http://bench/tree");
+        std::function <json::value (int)>
+    tree = [&](int depth)
+    {
+            json::value
+        node = { { "value", depth } };
+        if (depth > 0)
+        {
+                json::value::array_t
+            children;
+            for (int i = 0; i < 3; ++i)
+            {
+                children.push_back (tree (depth - 1));
+            }
+            node.get_object ()["children"] = std::move (children);
+        }
+        return node;
+    };
+        std::function <json::value (int)>
+    chain = [&](int depth)
+    {
+            json::value
+        node = { { "value", "x" } };
+        if (depth > 0)
+        {
+            node.get_object ()["children"] = json::value::array_t { chain (depth - 1) };
+        }
+        return node;
+    };
+    measure ("recursive-ref-tree", { { &validator, tree (7), "http://bench/tree" } });
+    measure ("recursive-ref-chain", { { &validator, chain (200), "http://bench/tree" } });
+}
+
+// Many patternProperties, on objects with many properties.
+    void
+pattern_properties (validator_t& validator)
+{
+        json::value
+    patterns = json::empty_object;
+    for (int i = 0; i < 20; ++i)
+    {
+        patterns.get_object ()[fmt::format ("^f{}_[a-z]+$", i)] = { { "type", "integer" } };
+    }
+    validator.add_schema (
+          { { "type", "object" }, { "patternProperties", patterns }, { "additionalProperties", false } }
+        , "http://bench/patterns"
+    );
+        std::vector <case_t>
+    cases;
+    for (int d = 0; d < 100; ++d)
+    {
+            json::value
+        object = json::empty_object;
+        for (int i = 0; i < 50; ++i)
+        {
+            object.get_object ()[fmt::format ("f{}_key{}", i % 20, std::string (1 + i % 5, 'a'))] = i;
+        }
+        cases.push_back ({ &validator, object, "http://bench/patterns" });
+    }
+    measure ("pattern-properties", cases);
+}
+
+// validate_schema () on big schemas.
+    void
+big_schemas (validator_t& validator)
+{
+        json::value
+    properties = json::empty_object;
+    for (int i = 0; i < 1000; ++i)
+    {
+        properties.get_object ()[fmt::format ("p{}", i)] = {
+              { "type", json::value::array_t { "string", "null" } }
+            , { "maxLength", i }
+            , { "description", fmt::format ("property {}", i) }
+            , { "items", { { "anyOf", json::value::array_t { { { "type", "integer" } }, { { "$ref", "#/definitions/x" } } } } } }
+        };
+    }
+        const json::value
+    big = {
+          { "$id", "http://bench/big" }
+        , { "type", "object" }
+        , { "properties", properties }
+        , { "definitions", { { "x", { { "type", "string" }, { "pattern", "^x" } } } } }
+    };
+        const auto
+    meta = json::from_string (detail::draft_07_schema);
+        const auto
+    meta_schema_uri = "http://json-schema.org/draft-07/schema"s;
+    measure ("validate-schema-big", { { &validator, big, meta_schema_uri } });
+    measure ("validate-schema-meta", { { &validator, meta, meta_schema_uri } });
+}
+
+    int
+main ()
+{
+    draft7_suite ();
+        validator_t
+    validator;
+    records (validator);
+    recursive_ref (validator);
+    pattern_properties (validator);
+    big_schemas (validator);
+}
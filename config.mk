@@ -8,5 +8,5 @@ PROJECT=json_validator
 LINK.o=${LINK.cc}
 CXXFLAGS+=-std=c++2a -Wall -Wextra -I../${FMTLIB_HEADERS} $(foreach dir, ${DEPENDENCIES_HEADERS}, -I../${dir})
 LDFLAGS+=
-LDLIBS+= -lfmt
+LDLIBS+= -lfmt -pthread
 
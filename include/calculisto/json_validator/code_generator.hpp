@@ -0,0 +1,828 @@
+#pragma once
+#include "json_validator.hpp"
+
+#include <limits>
+#include <map>
+#include <numeric>
+
+    namespace
+calculisto::json_validator
+{
+    namespace
+detail // {{{
+{
+    // A C++ string literal, with the "sv" suffix, that holds any bytes. Long
+    // ones are cut in lines.
+        inline std::string
+    cpp_literal (std::string_view s)
+    {
+            std::string
+        result = "\"";
+            std::size_t
+        line = 0;
+        for (unsigned char c: s)
+        {
+            if (line >= 100)
+            {
+                result += "\"\n        \"";
+                line = 0;
+            }
+            switch (c)
+            {
+                case '"':  result += "\\\""; break;
+                case '\\': result += "\\\\"; break;
+                case '\n': result += "\\n";  break;
+                case '\t': result += "\\t";  break;
+                default:
+                    if (c < 0x20 || c >= 0x7f)
+                    {
+                        // Three digits, so that a digit after it is not
+                        // taken in.
+                        result += fmt::format ("\\{:03o}", c);
+                    }
+                    else
+                    {
+                        result += static_cast <char> (c);
+                    }
+            }
+            ++line;
+        }
+        return result + "\"sv";
+    }
+
+    // A double literal that reads back as the same double.
+        inline std::string
+    cpp_double (double d)
+    {
+            auto
+        s = fmt::format ("{:.17g}", d);
+        if (s.find_first_of (".en") == std::string::npos)
+        {
+            s += ".0";
+        }
+        return s;
+    }
+
+    // A C++ expression of the value of a number.
+        inline std::string
+    cpp_number (const json_t& value)
+    {
+        switch (value.type ())
+        {
+            case tao::json::type::SIGNED:
+                if (value.get_signed () == std::numeric_limits <std::int64_t>::min ())
+                {
+                    return "std::int64_t (-9223372036854775807 - 1)";
+                }
+                return fmt::format ("std::int64_t ({})", value.get_signed ());
+            case tao::json::type::UNSIGNED:
+                return fmt::format ("std::uint64_t ({}u)", value.get_unsigned ());
+            default:
+                return cpp_double (value.as <double> ());
+        }
+    }
+} // }}} namespace detail
+
+// Generates a C++ header that validates instances against one schema with
+// straight-line code, for the schemas that are hot and seldom change:
+//
+//     code_generator_t generator { { { schema, "http://example.com/order" } }, "order" };
+//     std::ofstream { "order.hpp" } << generator.generate ();
+//
+// Each compiled sub-schema becomes a function, with its operands inlined:
+// "$ref" is a direct call, "properties" a switch on the length of the key
+// followed by comparisons with literals, and so is a discriminated "anyOf" or
+// "oneOf" on the value of its property, regular expressions are compiled
+// once, when the program starts. The header declares, in the given
+// namespace:
+//
+//     bool is_valid (json_t const& instance);
+//     std::pair <bool, json_t> validate (json_t const& instance);
+//
+// is_valid () answers like validator_t::is_valid (). validate () answers
+// like validator_t::validate (): a valid instance never leaves the generated
+// code, the errors of an invalid one are built by a validator_t that holds
+// the documents, embedded in the header, so that they have the same shape.
+// The generated header includes json_validator.hpp.
+    class
+code_generator_t
+{
+private:
+        std::vector <std::pair <std::string, std::string>>
+    documents_m;
+        std::string
+    schema_uri_m;
+        std::string
+    name_space_m;
+        validator_t
+    validator_m;
+    // The functions, by node, in the order they are generated.
+        std::unordered_map <detail::compiled_schema_ptr, std::size_t>
+    ids_m;
+        std::vector <detail::compiled_schema_ptr>
+    nodes_m;
+    // Namespace scope constants.
+        std::string
+    constants_m;
+        std::size_t
+    constant_count_m = 0;
+        std::unordered_map <const std::regex*, std::string>
+    regexes_m;
+
+        auto
+    id (detail::compiled_schema_ptr node)
+        -> std::size_t
+    {
+        if (
+                auto&&
+              i = ids_m.find (node)
+            ; i != ids_m.end ()
+        ){
+            return i->second;
+        }
+        ids_m.emplace (node, nodes_m.size ());
+        nodes_m.push_back (node);
+        return nodes_m.size () - 1;
+    }
+
+    // A call of the function of a node, folded for boolean schemas, and
+    // through the nodes that are only a reference.
+        auto
+    call (detail::compiled_schema_ptr node, std::string_view argument)
+        -> std::string
+    {
+        if (auto target = detail::resolve_references (node))
+        {
+            node = target;
+        }
+        if (node->is_boolean)
+        {
+            return node->boolean_value ? "true" : "false";
+        }
+        return fmt::format ("schema_{} ({})", id (node), argument);
+    }
+
+        auto
+    constant (std::string_view type, std::string const& initializer)
+        -> std::string
+    {
+            auto
+        name = fmt::format ("constant_{}", constant_count_m++);
+        constants_m += fmt::format ("    inline const {} {} = {};\n", type, name, initializer);
+        return name;
+    }
+
+        auto
+    json_constant (const json_t& value)
+        -> std::string
+    {
+        return constant ("json_t", fmt::format (
+              "tao::json::from_string ({})"
+            , detail::cpp_literal (tao::json::to_string (value))
+        ));
+    }
+
+        auto
+    number_constant (const detail::number_t& n)
+        -> std::string
+    {
+            json_t
+        value;
+        switch (n.kind)
+        {
+            case tao::json::type::SIGNED:
+                value = n.signed_value;
+                break;
+            case tao::json::type::UNSIGNED:
+                value = n.unsigned_value;
+                break;
+            default:
+                value = n.double_value;
+        }
+        return constant ("detail::number_t", fmt::format (
+              "detail::number_t::from (json_t {{ {} }})"
+            , detail::cpp_number (value)
+        ));
+    }
+
+        auto
+    regex_constant (const std::regex* regex, std::string const& pattern)
+        -> std::string
+    {
+        if (
+                auto&&
+              i = regexes_m.find (regex)
+            ; i != regexes_m.end ()
+        ){
+            return i->second;
+        }
+        return regexes_m[regex] = constant (
+              "std::regex"
+            , fmt::format ("std::regex {{ std::string {{ {} }} }}", detail::cpp_literal (pattern))
+        );
+    }
+
+    // The checks of an "anyOf", or of a "oneOf", on the given branches.
+        template <typename Line>
+        void
+    branch_checks (
+          std::vector <detail::compiled_schema_ptr> const& branches
+        , std::vector <std::size_t> const&                 indices
+        , bool                                             one_of
+        , int                                              indent
+        , Line&&                                           line
+    ){
+            std::vector <std::string>
+        calls;
+        for (auto&& i: indices)
+        {
+            calls.push_back (call (branches[i], "instance"));
+        }
+        if (!one_of)
+        {
+            line (indent, fmt::format ("if (!({})) return false;", calls.empty () ? "false" : fmt::format ("{}", fmt::join (calls, " || "))));
+            return;
+        }
+        line (indent, "{");
+        line (indent + 1, "int successes = 0;");
+        for (auto&& c: calls)
+        {
+            line (indent + 1, fmt::format ("if ({} && ++successes > 1) return false;", c));
+        }
+        line (indent + 1, "if (successes != 1) return false;");
+        line (indent, "}");
+    }
+
+    // An "anyOf" or a "oneOf". With a discriminator, the value of its
+    // property, on the length then on the literals, selects the candidate
+    // branches, as candidate_branches () does: an object without one of the
+    // values satisfies none of them, the other instances are checked
+    // against all of them.
+        template <typename Line>
+        void
+    applicator (
+          std::vector <detail::compiled_schema_ptr> const& branches
+        , const detail::discriminator_t*                   discriminator
+        , bool                                             one_of
+        , Line&&                                           line
+    ){
+        using namespace detail;
+            std::vector <std::size_t>
+        all (branches.size ());
+        std::iota (std::begin (all), std::end (all), std::size_t { 0 });
+        if (!discriminator)
+        {
+            branch_checks (branches, all, one_of, 2, line);
+            return;
+        }
+        // Sorted, so that the output does not depend on hashing.
+            std::map <std::size_t, std::map <std::string_view, std::vector <std::size_t> const*>>
+        by_size;
+        for (auto&& [value, indices]: discriminator->branches)
+        {
+            by_size[value.size ()].emplace (value, &indices);
+        }
+        line (2, "if (instance.is_object ())");
+        line (2, "{");
+        line (3, fmt::format ("auto const i = instance.get_object ().find ({});", cpp_literal (*discriminator->property)));
+        line (3, "if (i == instance.get_object ().end () || !i->second.is_string_type ()) return false;");
+        line (3, "auto const value = i->second.get_string_type ();");
+        line (3, "switch (value.size ())");
+        line (3, "{");
+        for (auto&& [size, values]: by_size)
+        {
+            line (4, fmt::format ("case {}:", size));
+            for (auto&& [value, indices]: values)
+            {
+                line (5, fmt::format ("if (value == {})", cpp_literal (value)));
+                line (5, "{");
+                branch_checks (branches, *indices, one_of, 6, line);
+                line (6, "break;");
+                line (5, "}");
+            }
+            line (5, "return false;");
+        }
+        line (4, "default:");
+        line (5, "return false;");
+        line (3, "}");
+        line (2, "}");
+        line (2, "else");
+        line (2, "{");
+        branch_checks (branches, all, one_of, 3, line);
+        line (2, "}");
+    }
+
+    // The body of the function of a node: the checks of is_valid_impl (), in
+    // the same order.
+        auto
+    function (detail::compiled_schema_ptr node)
+        -> std::string
+    {
+        using namespace detail;
+            auto const&
+        schema = *node;
+            std::string
+        b;
+            auto
+        line = [&](int indent, std::string const& text)
+        {
+            b.append (4 * indent, ' ');
+            b += text;
+            b += '\n';
+        };
+        if (schema.is_boolean)
+        {
+            line (2, schema.boolean_value ? "return true;" : "return false;");
+            return b;
+        }
+        if (schema.has (kw_ref))
+        {
+            if (!schema.ref)
+            {
+                line (2, fmt::format (
+                      "throw (std::runtime_error {{ std::string {{ {} }} }});"
+                    , cpp_literal (fmt::format (
+                          "Resolution of reference \"{}\" failed."
+                        , schema.ref_value->get_string ()
+                      ))
+                ));
+                return b;
+            }
+            line (2, fmt::format ("return {};", call (schema.ref, "instance")));
+            return b;
+        }
+        if (schema.has (kw_all_of))
+        {
+            for (auto&& sub_schema: schema.all_of)
+            {
+                line (2, fmt::format ("if (!{}) return false;", call (sub_schema, "instance")));
+            }
+        }
+        if (schema.has (kw_any_of))
+        {
+            applicator (schema.any_of, schema.any_of_discriminator, false, line);
+        }
+        if (schema.has (kw_one_of))
+        {
+            applicator (schema.one_of, schema.one_of_discriminator, true, line);
+        }
+        if (schema.has (kw_not))
+        {
+            line (2, fmt::format ("if ({}) return false;", call (schema.not_schema, "instance")));
+        }
+        if (schema.has (kw_if))
+        {
+            line (2, fmt::format ("if ({})", call (schema.if_schema, "instance")));
+            line (2, "{");
+            if (schema.has (kw_then))
+            {
+                line (3, fmt::format ("if (!{}) return false;", call (schema.then_schema, "instance")));
+            }
+            line (2, "}");
+            line (2, "else");
+            line (2, "{");
+            if (schema.has (kw_else))
+            {
+                line (3, fmt::format ("if (!{}) return false;", call (schema.else_schema, "instance")));
+            }
+            line (2, "}");
+        }
+        if (schema.has (kw_type))
+        {
+            line (2, fmt::format ("if (!(detail::type_mask (instance) & {})) return false;", schema.type));
+        }
+        if (schema.has (kw_enum))
+        {
+                auto
+            values = json_constant (json_t { *schema.enum_values });
+                auto
+            set = constant ("detail::value_set_t", fmt::format (
+                  "[] {{ detail::value_set_t s; for (auto&& i: {}.get_array ()) s.insert (i); return s; }} ()"
+                , values
+            ));
+            line (2, fmt::format ("if (!{}.contains (instance)) return false;", set));
+        }
+        if (schema.has (kw_const))
+        {
+            line (2, fmt::format ("if (instance != {}) return false;", json_constant (*schema.const_value)));
+        }
+        object_checks (schema, line);
+        array_checks (schema, line);
+        // Numbers.
+        if (
+               schema.has (kw_multiple_of)
+            || schema.has (kw_maximum)
+            || schema.has (kw_exclusive_maximum)
+            || schema.has (kw_minimum)
+            || schema.has (kw_exclusive_minimum)
+        ){
+            line (2, "if (instance.is_number ())");
+            line (2, "{");
+            if (schema.has (kw_multiple_of))
+            {
+                line (3, fmt::format (
+                      "if (std::remainder (instance.as <double> (), {}) != 0) return false;"
+                    , detail::cpp_double (schema.multiple_of)
+                ));
+            }
+            if (schema.has (kw_maximum))
+            {
+                line (3, fmt::format ("if (detail::compare (instance, {}) > 0) return false;", number_constant (schema.maximum)));
+            }
+            if (schema.has (kw_exclusive_maximum))
+            {
+                line (3, fmt::format ("if (detail::compare (instance, {}) >= 0) return false;", number_constant (schema.exclusive_maximum)));
+            }
+            if (schema.has (kw_minimum))
+            {
+                line (3, fmt::format ("if (detail::compare (instance, {}) < 0) return false;", number_constant (schema.minimum)));
+            }
+            if (schema.has (kw_exclusive_minimum))
+            {
+                line (3, fmt::format ("if (detail::compare (instance, {}) <= 0) return false;", number_constant (schema.exclusive_minimum)));
+            }
+            line (2, "}");
+        }
+        // Strings.
+        if (schema.has (kw_max_length) || schema.has (kw_min_length) || schema.has (kw_pattern))
+        {
+            line (2, "if (instance.is_string ())");
+            line (2, "{");
+            if (schema.has (kw_max_length))
+            {
+                line (3, fmt::format ("if (detail::longer_than (instance.get_string (), {}u)) return false;", schema.max_length));
+            }
+            if (schema.has (kw_min_length))
+            {
+                line (3, fmt::format ("if (detail::shorter_than (instance.get_string (), {}u)) return false;", schema.min_length));
+            }
+            if (schema.has (kw_pattern))
+            {
+                line (3, fmt::format (
+                      "if (!std::regex_search (instance.get_string (), {})) return false;"
+                    , regex_constant (schema.pattern_regex, *schema.pattern)
+                ));
+            }
+            line (2, "}");
+        }
+        line (2, "return true;");
+        return b;
+    }
+
+        template <typename Line>
+        void
+    object_checks (detail::compiled_schema_t const& schema, Line&& line)
+    {
+        using namespace detail;
+            auto
+        has_property = [](std::string_view property)
+        {
+            return fmt::format ("object.find ({}) != object.end ()", cpp_literal (property));
+        };
+        if (!(
+               schema.has (kw_dependencies)
+            || schema.has (kw_dependent_schemas)
+            || schema.has (kw_max_properties)
+            || schema.has (kw_min_properties)
+            || schema.has (kw_required)
+            || schema.has (kw_dependent_required)
+            || schema.has (kw_properties)
+            || schema.has (kw_pattern_properties)
+            || schema.has (kw_additional_properties)
+            || schema.has (kw_property_names)
+        )){
+            return;
+        }
+        line (2, "if (instance.is_object ())");
+        line (2, "{");
+        line (3, "[[maybe_unused]] auto const& object = instance.get_object ();");
+        if (schema.has (kw_dependencies))
+        {
+            for (auto&& dependency: schema.dependencies)
+            {
+                line (3, fmt::format ("if ({})", has_property (*dependency.property)));
+                line (3, "{");
+                if (!dependency.schema)
+                {
+                    for (auto&& i: dependency.required)
+                    {
+                        line (4, fmt::format ("if (!({})) return false;", has_property (i)));
+                    }
+                }
+                else
+                {
+                    line (4, fmt::format ("if (!{}) return false;", call (dependency.schema, "instance")));
+                }
+                line (3, "}");
+            }
+        }
+        if (schema.has (kw_dependent_schemas))
+        {
+            for (auto&& [property, sub_schema]: schema.dependent_schemas)
+            {
+                line (3, fmt::format (
+                      "if ({} && !{}) return false;"
+                    , has_property (*property)
+                    , call (sub_schema, "instance")
+                ));
+            }
+        }
+        if (schema.has (kw_max_properties))
+        {
+            line (3, fmt::format ("if (object.size () > {}u) return false;", schema.max_properties));
+        }
+        if (schema.has (kw_min_properties))
+        {
+            line (3, fmt::format ("if (object.size () < {}u) return false;", schema.min_properties));
+        }
+        if (schema.has (kw_required))
+        {
+            for (auto&& property: schema.required)
+            {
+                line (3, fmt::format ("if (!({})) return false;", has_property (*property)));
+            }
+        }
+        if (schema.has (kw_dependent_required))
+        {
+            // Sorted, so that the output does not depend on hashing.
+                std::map <std::string_view, std::vector <std::string_view>>
+            sorted (schema.dependent_required.begin (), schema.dependent_required.end ());
+            for (auto&& [property, required]: sorted)
+            {
+                line (3, fmt::format ("if ({})", has_property (property)));
+                line (3, "{");
+                for (auto&& i: required)
+                {
+                    line (4, fmt::format ("if (!({})) return false;", has_property (i)));
+                }
+                line (3, "}");
+            }
+        }
+        if (
+               schema.has (kw_properties)
+            || schema.has (kw_pattern_properties)
+            || schema.has (kw_additional_properties)
+            || schema.has (kw_property_names)
+        ){
+            line (3, "for (auto&& [property, value]: object)");
+            line (3, "{");
+            line (4, "[[maybe_unused]] bool apply_additional = true;");
+            if (!schema.properties.empty ())
+            {
+                    std::map <std::size_t, std::map <std::string_view, compiled_schema_ptr>>
+                by_size;
+                for (auto&& [property, sub_schema]: schema.properties)
+                {
+                    by_size[property.size ()].emplace (property, sub_schema);
+                }
+                line (4, "switch (property.size ())");
+                line (4, "{");
+                for (auto&& [size, properties]: by_size)
+                {
+                    line (5, fmt::format ("case {}:", size));
+                    for (auto&& [property, sub_schema]: properties)
+                    {
+                        line (6, fmt::format ("if (property == {})", cpp_literal (property)));
+                        line (6, "{");
+                        line (7, fmt::format ("if (!{}) return false;", call (sub_schema, "value")));
+                        line (7, "apply_additional = false;");
+                        line (7, "break;");
+                        line (6, "}");
+                    }
+                    line (6, "break;");
+                }
+                line (5, "default:");
+                line (6, "break;");
+                line (4, "}");
+            }
+            for (auto&& [pattern, regex, sub_schema]: schema.pattern_properties)
+            {
+                line (4, fmt::format ("if (std::regex_search (property, {}))", regex_constant (regex, *pattern)));
+                line (4, "{");
+                line (5, fmt::format ("if (!{}) return false;", call (sub_schema, "value")));
+                line (5, "apply_additional = false;");
+                line (4, "}");
+            }
+            if (schema.additional_properties)
+            {
+                line (4, fmt::format ("if (apply_additional && !{}) return false;", call (schema.additional_properties, "value")));
+            }
+            if (schema.property_names)
+            {
+                line (4, fmt::format ("if (!{}) return false;", call (schema.property_names, "json_t { property }")));
+            }
+            line (3, "}");
+        }
+        line (2, "}");
+    }
+
+        template <typename Line>
+        void
+    array_checks (detail::compiled_schema_t const& schema, Line&& line)
+    {
+        using namespace detail;
+        if (!(
+               schema.has (kw_max_items)
+            || schema.has (kw_min_items)
+            || schema.has (kw_items)
+            || schema.has (kw_contains)
+            || schema.has (kw_unique_items)
+        )){
+            return;
+        }
+        line (2, "if (instance.is_array ())");
+        line (2, "{");
+        line (3, "[[maybe_unused]] auto const& array = instance.get_array ();");
+        if (schema.has (kw_max_items))
+        {
+            line (3, fmt::format ("if (array.size () > {}u) return false;", schema.max_items));
+        }
+        if (schema.has (kw_min_items))
+        {
+            line (3, fmt::format ("if (array.size () < {}u) return false;", schema.min_items));
+        }
+        if (schema.has (kw_items))
+        {
+            line (3, "[[maybe_unused]] std::size_t index = 0;");
+            if (schema.items_is_array)
+            {
+                for (std::size_t i = 0; i < schema.items_array.size (); ++i)
+                {
+                    line (3, fmt::format (
+                          "if (array.size () > {}u && !{}) return false;"
+                        , i
+                        , call (schema.items_array[i], fmt::format ("array[{}]", i))
+                    ));
+                }
+                line (3, fmt::format ("index = std::min <std::size_t> (array.size (), {}u);", schema.items_array.size ()));
+            }
+            else
+            {
+                line (3, "for (; index < array.size (); ++index)");
+                line (3, "{");
+                line (4, fmt::format ("if (!{}) return false;", call (schema.items, "array[index]")));
+                line (3, "}");
+            }
+            if (schema.has (kw_additional_items))
+            {
+                line (3, "for (; index < array.size (); ++index)");
+                line (3, "{");
+                line (4, fmt::format ("if (!{}) return false;", call (schema.additional_items, "array[index]")));
+                line (3, "}");
+            }
+        }
+        if (schema.has (kw_contains))
+        {
+            line (3, "{");
+            line (4, "std::size_t count = 0;");
+            line (4, "for (auto&& i: array)");
+            line (4, "{");
+            line (5, fmt::format ("if ({}) ++count;", call (schema.contains, "i")));
+            line (4, "}");
+            line (4, "if (count == 0) return false;");
+            if (schema.has (kw_max_contains))
+            {
+                line (4, fmt::format ("if (count > {}u) return false;", schema.max_contains));
+            }
+            if (schema.has (kw_min_contains))
+            {
+                line (4, fmt::format ("if (count < {}u) return false;", schema.min_contains));
+            }
+            line (3, "}");
+        }
+        if (schema.has (kw_unique_items) && schema.unique_items)
+        {
+            line (3, "if (detail::has_duplicates (array)) return false;");
+        }
+        line (2, "}");
+    }
+
+public:
+    // The documents are registered in a validator_t, in order, and the
+    // header validates against the schema designated by schema_uri.
+    code_generator_t (
+          std::vector <std::pair <json_t, std::string>> const& documents
+        , std::string                                      schema_uri
+        , std::string                                      name_space
+    )
+        : schema_uri_m { std::move (schema_uri) }
+        , name_space_m { std::move (name_space) }
+    {
+        for (auto&& [document, uri]: documents)
+        {
+            validator_m.add_schema (document, uri);
+            documents_m.emplace_back (tao::json::to_string (document), uri);
+        }
+    }
+
+        auto
+    generate ()
+        -> std::string
+    {
+        ids_m.clear ();
+        nodes_m.clear ();
+        constants_m.clear ();
+        constant_count_m = 0;
+        regexes_m.clear ();
+            auto
+        root = &validator_m.find_schema (schema_uri_m);
+            std::string
+        functions;
+        // Generating a function discovers the nodes it calls.
+        call (root, "instance");
+        for (std::size_t i = 0; i < nodes_m.size (); ++i)
+        {
+                auto
+            body = function (nodes_m[i]);
+            functions += fmt::format (
+                  "    inline bool\n    schema_{} ([[maybe_unused]] json_t const& instance)\n    {{\n{}    }}\n\n"
+                , i
+                , body
+            );
+        }
+            std::string
+        declarations;
+        for (std::size_t i = 0; i < nodes_m.size (); ++i)
+        {
+            declarations += fmt::format ("    bool schema_{} (json_t const& instance);\n", i);
+        }
+            std::string
+        documents;
+        for (auto&& [text, uri]: documents_m)
+        {
+            documents += fmt::format (
+                  "            validator.add_schema (tao::json::from_string ({}), std::string {{ {} }});\n"
+                , detail::cpp_literal (text)
+                , detail::cpp_literal (uri)
+            );
+        }
+        return fmt::format (
+R"(// Generated by calculisto::json_validator::code_generator_t, for
+// {0}. Do not edit.
+#pragma once
+#include <calculisto/json_validator/json_validator.hpp>
+
+#include <cmath>
+#include <regex>
+
+    namespace
+{1}
+{{
+    namespace
+generated // {{{{{{
+{{
+    using namespace std::literals;
+    using namespace calculisto::json_validator;
+
+{2}
+{3}
+{4}    // Builds the errors of the invalid instances.
+        inline validator_t const&
+    interpreter ()
+    {{
+            static const validator_t
+        shared = []
+        {{
+                validator_t
+            validator;
+{5}            return validator;
+        }} ();
+        return shared;
+    }}
+}} // }}}}}} namespace generated
+
+    inline bool
+is_valid ([[maybe_unused]] calculisto::json_validator::json_t const& instance)
+{{
+    return {6};
+}}
+
+    inline auto
+validate (calculisto::json_validator::json_t const& instance)
+    -> std::pair <bool, calculisto::json_validator::json_t>
+{{
+    using namespace std::literals;
+    if (is_valid (instance))
+    {{
+        return {{ true, tao::json::null }};
+    }}
+    return generated::interpreter ().validate (instance, std::string {{ {7} }});
+}}
+
+}} // namespace {1}
+)"
+            , schema_uri_m
+            , name_space_m
+            , declarations
+            , constants_m
+            , functions
+            , documents
+            , root->is_boolean
+                ? (root->boolean_value ? "true" : "false")
+                : "generated::schema_0 (instance)"
+            , detail::cpp_literal (schema_uri_m)
+        );
+    }
+};
+
+} // namespace calculisto::json_validator
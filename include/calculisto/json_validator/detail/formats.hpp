@@ -0,0 +1,796 @@
+#pragma once
+#include <calculisto/uri/uri.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <string>
+#include <string_view>
+
+    namespace
+calculisto::json_validator::detail::formats
+{
+// Checks of the draft-07 "format" values. Each one is a single pass over the
+// string, with no allocation: "uri" and "uri-reference" only hand the strings
+// that pass their own scan to calculisto::uri, for the whole grammar.
+
+    enum class
+format_t
+    : std::uint8_t
+{
+      unknown
+    , date_time
+    , date
+    , time
+    , email
+    , hostname
+    , ipv4
+    , ipv6
+    , uri
+    , uri_reference
+    , uuid
+    , json_pointer
+    , relative_json_pointer
+    , regex
+};
+
+    inline constexpr std::array <std::string_view, 14>
+format_names {
+      ""
+    , "date-time"
+    , "date"
+    , "time"
+    , "email"
+    , "hostname"
+    , "ipv4"
+    , "ipv6"
+    , "uri"
+    , "uri-reference"
+    , "uuid"
+    , "json-pointer"
+    , "relative-json-pointer"
+    , "regex"
+};
+
+    constexpr auto
+format_name (format_t format) noexcept
+    -> std::string_view
+{
+    return format_names[static_cast <std::size_t> (format)];
+}
+
+// The format of a name. Unknown formats are not asserted.
+    constexpr auto
+format_from (std::string_view name) noexcept
+    -> format_t
+{
+    for (std::size_t i = 1; i < format_names.size (); ++i)
+    {
+        if (format_names[i] == name)
+        {
+            return static_cast <format_t> (i);
+        }
+    }
+    return format_t::unknown;
+}
+
+    constexpr bool
+is_digit (char c) noexcept
+{
+    return c >= '0' && c <= '9';
+}
+
+    constexpr bool
+is_alpha (char c) noexcept
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+    constexpr bool
+is_hex (char c) noexcept
+{
+    return is_digit (c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+// The value of count digits at position i, or -1.
+    constexpr auto
+digits (std::string_view s, std::size_t i, std::size_t count) noexcept
+    -> int
+{
+    if (i + count > s.size ())
+    {
+        return -1;
+    }
+        int
+    v = 0;
+    for (std::size_t j = i; j < i + count; ++j)
+    {
+        if (!is_digit (s[j]))
+        {
+            return -1;
+        }
+        v = v * 10 + (s[j] - '0');
+    }
+    return v;
+}
+
+// RFC 3339 full-date, at the start of s.
+    constexpr bool
+full_date (std::string_view s) noexcept
+{
+        auto
+    year = digits (s, 0, 4);
+        auto
+    month = digits (s, 5, 2);
+        auto
+    day = digits (s, 8, 2);
+    if (year < 0 || month < 1 || month > 12 || day < 1 || s[4] != '-' || s[7] != '-')
+    {
+        return false;
+    }
+        constexpr int
+    days[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+        auto
+    leap = year % 4 == 0 && (year % 100 != 0 || year % 400 == 0);
+    return day <= days[month - 1] + (month == 2 && leap);
+}
+
+// RFC 3339 full-time. A leap second is only valid at 23:59 UTC.
+    constexpr bool
+full_time (std::string_view s) noexcept
+{
+        auto
+    hour = digits (s, 0, 2);
+        auto
+    minute = digits (s, 3, 2);
+        auto
+    second = digits (s, 6, 2);
+    if (
+           hour < 0 || hour > 23 || minute < 0 || minute > 59 || second < 0 || second > 60
+        || s[2] != ':' || s[5] != ':'
+    ){
+        return false;
+    }
+        std::size_t
+    i = 8;
+    if (i < s.size () && s[i] == '.')
+    {
+        ++i;
+        if (i == s.size () || !is_digit (s[i]))
+        {
+            return false;
+        }
+        while (i < s.size () && is_digit (s[i]))
+        {
+            ++i;
+        }
+    }
+    if (i == s.size ())
+    {
+        return false;
+    }
+        int
+    offset = 0;
+    if (s[i] == 'Z' || s[i] == 'z')
+    {
+        if (i + 1 != s.size ())
+        {
+            return false;
+        }
+    }
+    else if (s[i] == '+' || s[i] == '-')
+    {
+            auto
+        offset_hour = digits (s, i + 1, 2);
+            auto
+        offset_minute = digits (s, i + 4, 2);
+        if (
+               offset_hour < 0 || offset_hour > 23 || offset_minute < 0 || offset_minute > 59
+            || s[i + 3] != ':' || i + 6 != s.size ()
+        ){
+            return false;
+        }
+        offset = (s[i] == '+' ? 1 : -1) * (offset_hour * 60 + offset_minute);
+    }
+    else
+    {
+        return false;
+    }
+    return second < 60 || ((hour * 60 + minute - offset) % 1440 + 1440) % 1440 == 23 * 60 + 59;
+}
+
+    constexpr bool
+is_date (std::string_view s) noexcept
+{
+    return s.size () == 10 && full_date (s);
+}
+
+    constexpr bool
+is_time (std::string_view s) noexcept
+{
+    return full_time (s);
+}
+
+    constexpr bool
+is_date_time (std::string_view s) noexcept
+{
+    return s.size () > 11 && (s[10] == 'T' || s[10] == 't') && full_date (s) && full_time (s.substr (11));
+}
+
+// RFC 1123 host name: dot-separated labels of letters, digits and hyphens,
+// of 63 characters at most, that neither start nor end with a hyphen.
+    constexpr bool
+is_hostname (std::string_view s) noexcept
+{
+    if (s.empty () || s.size () > 253)
+    {
+        return false;
+    }
+        std::size_t
+    label = 0;
+    for (std::size_t i = 0; i <= s.size (); ++i)
+    {
+        if (i == s.size () || s[i] == '.')
+        {
+            if (label == 0 || label > 63 || s[i - 1] == '-')
+            {
+                return false;
+            }
+            label = 0;
+            continue;
+        }
+        if (!(is_alpha (s[i]) || is_digit (s[i]) || (s[i] == '-' && label > 0)))
+        {
+            return false;
+        }
+        ++label;
+    }
+    return true;
+}
+
+// Dotted-quad, without leading zeros, which some parsers read as octal.
+    constexpr bool
+is_ipv4 (std::string_view s) noexcept
+{
+        std::size_t
+    i = 0;
+    for (int part = 0; part < 4; ++part)
+    {
+        if (part > 0)
+        {
+            if (i == s.size () || s[i] != '.')
+            {
+                return false;
+            }
+            ++i;
+        }
+            std::size_t
+        start = i;
+            int
+        v = 0;
+        while (i < s.size () && is_digit (s[i]) && i - start < 3)
+        {
+            v = v * 10 + (s[i++] - '0');
+        }
+        if (i == start || v > 255 || (s[start] == '0' && i - start > 1))
+        {
+            return false;
+        }
+    }
+    return i == s.size ();
+}
+
+// RFC 4291 text form: eight groups of 1 to 4 hexadecimal digits, a run of
+// which may be compressed to "::", the last two of which may be written as
+// an IPv4 address.
+    constexpr bool
+is_ipv6 (std::string_view s) noexcept
+{
+    if (s.size () < 2 || s.size () > 45)
+    {
+        return false;
+    }
+        int
+    groups = 0;
+        bool
+    compressed = false;
+        std::size_t
+    i = 0;
+    if (s[0] == ':')
+    {
+        if (s[1] != ':')
+        {
+            return false;
+        }
+        compressed = true;
+        i = 2;
+    }
+    while (i < s.size ())
+    {
+            std::size_t
+        start = i;
+        while (i < s.size () && is_hex (s[i]) && i - start < 4)
+        {
+            ++i;
+        }
+        if (i == start)
+        {
+            return false;
+        }
+        if (i < s.size () && s[i] == '.')
+        {
+            if (groups > 6 || !is_ipv4 (s.substr (start)))
+            {
+                return false;
+            }
+            groups += 2;
+            i = s.size ();
+            break;
+        }
+        ++groups;
+        if (i == s.size ())
+        {
+            break;
+        }
+        if (s[i] != ':')
+        {
+            return false;
+        }
+        ++i;
+        if (i < s.size () && s[i] == ':')
+        {
+            if (compressed)
+            {
+                return false;
+            }
+            compressed = true;
+            ++i;
+        }
+        else if (i == s.size ())
+        {
+            return false;
+        }
+    }
+    return compressed ? groups < 8 : groups == 8;
+}
+
+// RFC 5322 addr-spec: a dot-atom or quoted local part, and a host name or
+// an address literal.
+    constexpr bool
+is_email (std::string_view s) noexcept
+{
+        std::size_t
+    i = 0;
+    if (!s.empty () && s[0] == '"')
+    {
+        for (i = 1; i < s.size () && s[i] != '"'; ++i)
+        {
+            if (s[i] == '\\')
+            {
+                ++i;
+            }
+            if (i == s.size () || static_cast <unsigned char> (s[i]) < 0x20 || s[i] == 0x7f)
+            {
+                return false;
+            }
+        }
+        if (i == s.size ())
+        {
+            return false;
+        }
+        ++i;
+    }
+    else
+    {
+            constexpr std::string_view
+        specials = "!#$%&'*+-/=?^_`{|}~";
+        for (; i < s.size () && s[i] != '@'; ++i)
+        {
+            if (s[i] == '.')
+            {
+                if (i == 0 || s[i - 1] == '.' || i + 1 == s.size () || s[i + 1] == '@')
+                {
+                    return false;
+                }
+                continue;
+            }
+            if (!(is_alpha (s[i]) || is_digit (s[i]) || specials.find (s[i]) != specials.npos))
+            {
+                return false;
+            }
+        }
+    }
+    if (i == 0 || i == s.size () || s[i] != '@')
+    {
+        return false;
+    }
+        auto
+    domain = s.substr (i + 1);
+    if (domain.size () > 2 && domain.front () == '[' && domain.back () == ']')
+    {
+            auto
+        literal = domain.substr (1, domain.size () - 2);
+        if (literal.starts_with ("IPv6:"))
+        {
+            return is_ipv6 (literal.substr (5));
+        }
+        return is_ipv4 (literal);
+    }
+    return is_hostname (domain);
+}
+
+// 8-4-4-4-12 hexadecimal digits.
+    constexpr bool
+is_uuid (std::string_view s) noexcept
+{
+    if (s.size () != 36)
+    {
+        return false;
+    }
+    for (std::size_t i = 0; i < s.size (); ++i)
+    {
+        if (i == 8 || i == 13 || i == 18 || i == 23)
+        {
+            if (s[i] != '-')
+            {
+                return false;
+            }
+        }
+        else if (!is_hex (s[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// RFC 6901: "~" only escapes "0" and "1".
+    constexpr bool
+is_json_pointer (std::string_view s) noexcept
+{
+    if (!s.empty () && s[0] != '/')
+    {
+        return false;
+    }
+    for (std::size_t i = 0; i < s.size (); ++i)
+    {
+        if (s[i] == '~' && (i + 1 == s.size () || (s[i + 1] != '0' && s[i + 1] != '1')))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// A non-negative integer, then "#" or a JSON pointer.
+    constexpr bool
+is_relative_json_pointer (std::string_view s) noexcept
+{
+        std::size_t
+    i = 0;
+    while (i < s.size () && is_digit (s[i]))
+    {
+        ++i;
+    }
+    if (i == 0 || (s[0] == '0' && i > 1))
+    {
+        return false;
+    }
+    return s.substr (i) == "#" || is_json_pointer (s.substr (i));
+}
+
+// The characters of RFC 3986, with well-formed percent escapes and a single
+// "#". absolute requires a scheme, otherwise a first segment with a colon
+// must be preceded by a scheme.
+    constexpr bool
+uri_scan (std::string_view s, bool absolute) noexcept
+{
+        constexpr std::string_view
+    allowed = "-._~:/?#[]@!$&'()*+,;=";
+        std::size_t
+    scheme = 0;
+    if (!s.empty () && is_alpha (s[0]))
+    {
+        for (scheme = 1; scheme < s.size (); ++scheme)
+        {
+            if (!(is_alpha (s[scheme]) || is_digit (s[scheme]) || s[scheme] == '+' || s[scheme] == '-' || s[scheme] == '.'))
+            {
+                break;
+            }
+        }
+        if (scheme == s.size () || s[scheme] != ':')
+        {
+            scheme = 0;
+        }
+    }
+    if (absolute && scheme == 0)
+    {
+        return false;
+    }
+        bool
+    fragment = false;
+        bool
+    first_segment = scheme == 0;
+    for (std::size_t i = scheme; i < s.size (); ++i)
+    {
+            auto
+        c = s[i];
+        if (c == '%')
+        {
+            if (i + 2 >= s.size () || !is_hex (s[i + 1]) || !is_hex (s[i + 2]))
+            {
+                return false;
+            }
+            i += 2;
+            continue;
+        }
+        if (c == '#')
+        {
+            if (fragment)
+            {
+                return false;
+            }
+            fragment = true;
+        }
+        if (c == '/' || c == '?' || c == '#')
+        {
+            first_segment = false;
+        }
+        if (c == ':' && first_segment)
+        {
+            return false;
+        }
+        if (!(is_alpha (c) || is_digit (c) || allowed.find (c) != allowed.npos))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+    inline bool
+is_uri (std::string_view s, bool absolute)
+{
+    if (!uri_scan (s, absolute))
+    {
+        return false;
+    }
+    try
+    {
+            calculisto::uri::uri_t
+        parsed { std::string { s } };
+        static_cast <void> (parsed);
+        return true;
+    }
+    catch (std::exception const&)
+    {
+        return false;
+    }
+}
+
+// ECMA-262 syntax: balanced groups and classes, known escapes, quantifiers
+// after an atom and well-formed bounds.
+    constexpr bool
+is_regex (std::string_view s) noexcept
+{
+        std::size_t
+    depth = 0;
+    // Whether the last term can take a quantifier, and whether it has one.
+        bool
+    atom = false;
+        bool
+    quantified = false;
+        auto
+    escape = [&](std::size_t& i)
+    {
+        if (++i == s.size ())
+        {
+            return false;
+        }
+            auto
+        c = s[i];
+        if (c == 'x')
+        {
+            i += 2;
+            return i < s.size () && is_hex (s[i - 1]) && is_hex (s[i]);
+        }
+        if (c == 'u')
+        {
+            i += 4;
+            return i < s.size () && is_hex (s[i - 3]) && is_hex (s[i - 2]) && is_hex (s[i - 1]) && is_hex (s[i]);
+        }
+        if (c == 'c')
+        {
+            return ++i < s.size () && is_alpha (s[i]);
+        }
+        return !is_alpha (c) || std::string_view { "dDwWsSbBfnrtvkpP" }.find (c) != std::string_view::npos;
+    };
+    for (std::size_t i = 0; i < s.size (); ++i)
+    {
+            auto
+        c = s[i];
+        switch (c)
+        {
+            case '\\':
+                if (!escape (i))
+                {
+                    return false;
+                }
+                atom = s[i] != 'b' && s[i] != 'B';
+                quantified = false;
+                break;
+            case '[':
+                for (++i; i < s.size () && s[i] != ']'; ++i)
+                {
+                    if (s[i] == '\\' && !escape (i))
+                    {
+                        return false;
+                    }
+                }
+                if (i == s.size ())
+                {
+                    return false;
+                }
+                atom = true;
+                quantified = false;
+                break;
+            case '(':
+                if (i + 1 < s.size () && s[i + 1] == '?')
+                {
+                    i += 2;
+                    if (i == s.size ())
+                    {
+                        return false;
+                    }
+                    if (s[i] == '<' && i + 1 < s.size () && (s[i + 1] == '=' || s[i + 1] == '!'))
+                    {
+                        ++i;
+                    }
+                    else if (s[i] == '<')
+                    {
+                        for (++i; i < s.size () && s[i] != '>'; ++i)
+                        {
+                            if (!(is_alpha (s[i]) || is_digit (s[i]) || s[i] == '_' || s[i] == '$'))
+                            {
+                                return false;
+                            }
+                        }
+                        if (i == s.size ())
+                        {
+                            return false;
+                        }
+                    }
+                    else if (s[i] != ':' && s[i] != '=' && s[i] != '!')
+                    {
+                        return false;
+                    }
+                }
+                ++depth;
+                atom = false;
+                quantified = false;
+                break;
+            case ')':
+                if (depth == 0)
+                {
+                    return false;
+                }
+                --depth;
+                atom = true;
+                quantified = false;
+                break;
+            case '|':
+            case '^':
+            case '$':
+                atom = false;
+                quantified = false;
+                break;
+            case '*':
+            case '+':
+            case '?':
+                if (c == '?' && quantified)
+                {
+                    // Lazy.
+                    quantified = false;
+                    break;
+                }
+                if (!atom)
+                {
+                    return false;
+                }
+                atom = false;
+                quantified = true;
+                break;
+            case '{':
+            {
+                    auto
+                j = i + 1;
+                    std::uint64_t
+                low = 0;
+                    std::uint64_t
+                high = 0;
+                while (j < s.size () && is_digit (s[j]) && low < 1'000'000'000)
+                {
+                    low = low * 10 + static_cast <std::uint64_t> (s[j++] - '0');
+                }
+                    auto
+                bounded = j > i + 1;
+                high = low;
+                if (bounded && j < s.size () && s[j] == ',')
+                {
+                    ++j;
+                    if (j < s.size () && is_digit (s[j]))
+                    {
+                        high = 0;
+                        while (j < s.size () && is_digit (s[j]) && high < 1'000'000'000)
+                        {
+                            high = high * 10 + static_cast <std::uint64_t> (s[j++] - '0');
+                        }
+                    }
+                    else
+                    {
+                        high = low;
+                    }
+                }
+                if (!bounded || j == s.size () || s[j] != '}')
+                {
+                    // Not a quantifier: a literal brace.
+                    atom = true;
+                    quantified = false;
+                    break;
+                }
+                if (!atom || high < low)
+                {
+                    return false;
+                }
+                i = j;
+                atom = false;
+                quantified = true;
+                break;
+            }
+            default:
+                atom = true;
+                quantified = false;
+        }
+    }
+    return depth == 0;
+}
+
+// Whether s is valid for a known format.
+    inline bool
+check (format_t format, std::string_view s)
+{
+    switch (format)
+    {
+        case format_t::date_time:
+            return is_date_time (s);
+        case format_t::date:
+            return is_date (s);
+        case format_t::time:
+            return is_time (s);
+        case format_t::email:
+            return is_email (s);
+        case format_t::hostname:
+            return is_hostname (s);
+        case format_t::ipv4:
+            return is_ipv4 (s);
+        case format_t::ipv6:
+            return is_ipv6 (s);
+        case format_t::uri:
+            return is_uri (s, true);
+        case format_t::uri_reference:
+            return is_uri (s, false);
+        case format_t::uuid:
+            return is_uuid (s);
+        case format_t::json_pointer:
+            return is_json_pointer (s);
+        case format_t::relative_json_pointer:
+            return is_relative_json_pointer (s);
+        case format_t::regex:
+            return is_regex (s);
+        default:
+            return true;
+    }
+}
+
+} // namespace calculisto::json_validator::detail::formats
@@ -0,0 +1,292 @@
+#pragma once
+#include <cstddef>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#if defined (__x86_64__) || defined (__i386__)
+#   include <immintrin.h>
+#   define CALCULISTO_JSON_VALIDATOR_X86
+#endif
+
+    namespace
+calculisto::json_validator::detail::simd
+{
+// Kernels for the bulk checks, in an AVX2 and an SSE2 version on x86, and a
+// scalar one. The version is picked at run time, once, from what the CPU
+// supports: the code is built for the baseline target.
+
+    enum class
+level_t
+{
+      scalar
+    , sse2
+    , avx2
+};
+
+    inline auto
+detect_level () noexcept
+    -> level_t
+{
+#ifdef CALCULISTO_JSON_VALIDATOR_X86
+    __builtin_cpu_init ();
+    if (__builtin_cpu_supports ("avx2"))
+    {
+        return level_t::avx2;
+    }
+    if (__builtin_cpu_supports ("sse2"))
+    {
+        return level_t::sse2;
+    }
+#endif
+    return level_t::scalar;
+}
+
+    inline auto
+level () noexcept
+    -> level_t
+{
+        static const level_t
+    l = detect_level ();
+    return l;
+}
+
+// The bounds of a numeric range. An absent bound is infinite, so that no
+// value is out of it.
+    struct
+range_t
+{
+        double
+    minimum = -std::numeric_limits <double>::infinity ();
+        double
+    maximum = std::numeric_limits <double>::infinity ();
+        double
+    exclusive_minimum = -std::numeric_limits <double>::infinity ();
+        double
+    exclusive_maximum = std::numeric_limits <double>::infinity ();
+};
+
+// The bit i of the result is set when values[i] is out of the range. count is
+// at most 64.
+    inline auto
+out_of_range_scalar (const double* values, std::size_t count, range_t const& r) noexcept
+    -> std::uint64_t
+{
+        std::uint64_t
+    out = 0;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+            auto
+        v = values[i];
+        if (!(v >= r.minimum && v <= r.maximum && v > r.exclusive_minimum && v < r.exclusive_maximum))
+        {
+            out |= std::uint64_t { 1 } << i;
+        }
+    }
+    return out;
+}
+
+#ifdef CALCULISTO_JSON_VALIDATOR_X86
+    __attribute__ ((target ("sse2")))
+    inline auto
+out_of_range_sse2 (const double* values, std::size_t count, range_t const& r) noexcept
+    -> std::uint64_t
+{
+        auto const
+    minimum = _mm_set1_pd (r.minimum);
+        auto const
+    maximum = _mm_set1_pd (r.maximum);
+        auto const
+    exclusive_minimum = _mm_set1_pd (r.exclusive_minimum);
+        auto const
+    exclusive_maximum = _mm_set1_pd (r.exclusive_maximum);
+        std::uint64_t
+    out = 0;
+        std::size_t
+    i = 0;
+    for (; i + 2 <= count; i += 2)
+    {
+            auto
+        v = _mm_loadu_pd (values + i);
+            auto
+        in = _mm_and_pd (
+              _mm_and_pd (_mm_cmpge_pd (v, minimum), _mm_cmple_pd (v, maximum))
+            , _mm_and_pd (_mm_cmpgt_pd (v, exclusive_minimum), _mm_cmplt_pd (v, exclusive_maximum))
+        );
+        out |= static_cast <std::uint64_t> (~_mm_movemask_pd (in) & 0x3) << i;
+    }
+    if (i < count)
+    {
+        out |= out_of_range_scalar (values + i, count - i, r) << i;
+    }
+    return out;
+}
+
+    __attribute__ ((target ("avx2")))
+    inline auto
+out_of_range_avx2 (const double* values, std::size_t count, range_t const& r) noexcept
+    -> std::uint64_t
+{
+        auto const
+    minimum = _mm256_set1_pd (r.minimum);
+        auto const
+    maximum = _mm256_set1_pd (r.maximum);
+        auto const
+    exclusive_minimum = _mm256_set1_pd (r.exclusive_minimum);
+        auto const
+    exclusive_maximum = _mm256_set1_pd (r.exclusive_maximum);
+        std::uint64_t
+    out = 0;
+        std::size_t
+    i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+            auto
+        v = _mm256_loadu_pd (values + i);
+            auto
+        in = _mm256_and_pd (
+              _mm256_and_pd (_mm256_cmp_pd (v, minimum, _CMP_GE_OQ), _mm256_cmp_pd (v, maximum, _CMP_LE_OQ))
+            , _mm256_and_pd (_mm256_cmp_pd (v, exclusive_minimum, _CMP_GT_OQ), _mm256_cmp_pd (v, exclusive_maximum, _CMP_LT_OQ))
+        );
+        out |= static_cast <std::uint64_t> (~_mm256_movemask_pd (in) & 0xf) << i;
+    }
+    if (i < count)
+    {
+        out |= out_of_range_scalar (values + i, count - i, r) << i;
+    }
+    return out;
+}
+#endif
+
+    inline auto
+out_of_range (const double* values, std::size_t count, range_t const& r) noexcept
+    -> std::uint64_t
+{
+#ifdef CALCULISTO_JSON_VALIDATOR_X86
+    switch (level ())
+    {
+        case level_t::avx2:
+            return out_of_range_avx2 (values, count, r);
+        case level_t::sse2:
+            return out_of_range_sse2 (values, count, r);
+        default:
+            break;
+    }
+#endif
+    return out_of_range_scalar (values, count, r);
+}
+
+// The number of code points of UTF-8 text: the number of its bytes that are
+// not continuation bytes (10xxxxxx). A block of ASCII is counted without
+// looking at its bytes one by one.
+    inline auto
+code_points_scalar (const char* text, std::size_t size) noexcept
+    -> std::size_t
+{
+        constexpr std::uint64_t
+    high_bits = 0x8080808080808080;
+        std::size_t
+    count = 0;
+        std::size_t
+    i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+            std::uint64_t
+        word;
+        std::memcpy (&word, text + i, 8);
+        if (!(word & high_bits))
+        {
+            count += 8;
+            continue;
+        }
+        // The bit 7 of a continuation byte is set, its bit 6 is not.
+        count += 8 - static_cast <std::size_t> (std::popcount (word & ~(word << 1) & high_bits));
+    }
+    for (; i < size; ++i)
+    {
+        count += (static_cast <unsigned char> (text[i]) & 0xc0) != 0x80;
+    }
+    return count;
+}
+
+#ifdef CALCULISTO_JSON_VALIDATOR_X86
+    __attribute__ ((target ("sse2")))
+    inline auto
+code_points_sse2 (const char* text, std::size_t size) noexcept
+    -> std::size_t
+{
+    // As signed bytes, the continuation bytes are those below -64.
+        auto const
+    continuation = _mm_set1_epi8 (-64);
+        std::size_t
+    count = 0;
+        std::size_t
+    i = 0;
+    for (; i + 16 <= size; i += 16)
+    {
+            auto
+        v = _mm_loadu_si128 (reinterpret_cast <const __m128i*> (text + i));
+        if (!_mm_movemask_epi8 (v))
+        {
+            count += 16;
+            continue;
+        }
+        count += 16 - static_cast <std::size_t> (std::popcount (static_cast <unsigned> (
+            _mm_movemask_epi8 (_mm_cmpgt_epi8 (continuation, v))
+        )));
+    }
+    return count + code_points_scalar (text + i, size - i);
+}
+
+    __attribute__ ((target ("avx2")))
+    inline auto
+code_points_avx2 (const char* text, std::size_t size) noexcept
+    -> std::size_t
+{
+        auto const
+    continuation = _mm256_set1_epi8 (-64);
+        std::size_t
+    count = 0;
+        std::size_t
+    i = 0;
+    for (; i + 32 <= size; i += 32)
+    {
+            auto
+        v = _mm256_loadu_si256 (reinterpret_cast <const __m256i*> (text + i));
+        if (!_mm256_movemask_epi8 (v))
+        {
+            count += 32;
+            continue;
+        }
+        count += 32 - static_cast <std::size_t> (std::popcount (static_cast <unsigned> (
+            _mm256_movemask_epi8 (_mm256_cmpgt_epi8 (continuation, v))
+        )));
+    }
+    return count + code_points_scalar (text + i, size - i);
+}
+#endif
+
+    inline auto
+code_points (const char* text, std::size_t size) noexcept
+    -> std::size_t
+{
+#ifdef CALCULISTO_JSON_VALIDATOR_X86
+    // The kernels only pay off past a block.
+    if (size >= 32)
+    {
+        switch (level ())
+        {
+            case level_t::avx2:
+                return code_points_avx2 (text, size);
+            case level_t::sse2:
+                return code_points_sse2 (text, size);
+            default:
+                break;
+        }
+    }
+#endif
+    return code_points_scalar (text, size);
+}
+
+} // namespace calculisto::json_validator::detail::simd
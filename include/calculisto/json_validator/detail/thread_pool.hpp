@@ -0,0 +1,278 @@
+#pragma once
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+    namespace
+calculisto::json_validator::detail
+{
+// Runs sets of tasks on a few threads, started once with the pool and kept
+// waiting between the sets. Each worker starts with a contiguous share of the
+// tasks, takes them from the back of its own queue and, once it is empty,
+// steals from the front of the others'.
+    class
+work_stealing_pool_t
+{
+        struct
+    queue_t
+    {
+            std::mutex
+        mutex;
+            std::deque <std::size_t>
+        tasks;
+    };
+
+        std::size_t
+    threads_m;
+        std::vector <std::thread>
+    workers_m;
+    // Held by run () for the whole set: the sets of concurrent callers are
+    // run one after the other.
+        std::mutex
+    run_mutex_m;
+        std::mutex
+    mutex_m;
+        std::condition_variable
+    wake_m;
+        std::condition_variable
+    done_m;
+    // Bumped for each set, so that the workers tell a new set from a
+    // spurious wake up.
+        std::size_t
+    generation_m = 0;
+    // The workers that take part in the set, the calling thread included,
+    // and those of the started threads that are not done with it.
+        std::size_t
+    active_m = 0;
+        std::size_t
+    pending_m = 0;
+        bool
+    stopping_m = false;
+        std::function <void (std::size_t)>
+    job_m;
+    // The pool whose task the current thread runs, if any.
+        static inline thread_local const work_stealing_pool_t*
+    running_m = nullptr;
+
+        void
+    serve (std::size_t worker)
+    {
+        running_m = this;
+            std::size_t
+        seen = 0;
+        for (;;)
+        {
+                std::unique_lock
+            lock { mutex_m };
+            wake_m.wait (lock, [&]{ return stopping_m || generation_m != seen; });
+            if (stopping_m)
+            {
+                return;
+            }
+            seen = generation_m;
+            if (worker >= active_m)
+            {
+                continue;
+            }
+            lock.unlock ();
+            job_m (worker);
+            lock.lock ();
+            if (--pending_m == 0)
+            {
+                done_m.notify_one ();
+            }
+        }
+    }
+
+public:
+    // 0 means one thread per hardware thread. The calling thread of run ()
+    // is one of them: threads - 1 are started.
+        explicit
+    work_stealing_pool_t (std::size_t threads = 0)
+        : threads_m { threads ? threads : std::max (1u, std::thread::hardware_concurrency ()) }
+    {
+        for (std::size_t w = 1; w < threads_m; ++w)
+        {
+            workers_m.emplace_back (&work_stealing_pool_t::serve, this, w);
+        }
+    }
+
+    work_stealing_pool_t (const work_stealing_pool_t&) = delete;
+        work_stealing_pool_t&
+    operator = (const work_stealing_pool_t&) = delete;
+
+    ~work_stealing_pool_t ()
+    {
+        {
+                std::lock_guard
+            lock { mutex_m };
+            stopping_m = true;
+        }
+        wake_m.notify_all ();
+        for (auto&& worker: workers_m)
+        {
+            worker.join ();
+        }
+    }
+
+        std::size_t
+    threads () const noexcept
+    {
+        return threads_m;
+    }
+
+    // Calls task (index, worker) once for each index in [0, count). The
+    // calling thread is worker 0. The first exception thrown by a task is
+    // rethrown once all the workers are done. A task that runs a set on its
+    // own pool runs it on its own thread, as worker 0.
+        template <typename Task>
+        void
+    run (std::size_t count, Task&& task)
+    {
+        if (running_m == this)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                task (i, 0);
+            }
+            return;
+        }
+            std::lock_guard
+        run_lock { run_mutex_m };
+            auto
+        workers = std::min (threads_m, std::max <std::size_t> (count, 1));
+            std::vector <queue_t>
+        queues (workers);
+        for (std::size_t w = 0; w < workers; ++w)
+        {
+            for (
+                  auto i = count * w / workers
+                ; i < count * (w + 1) / workers
+                ; ++i
+            ){
+                queues[w].tasks.push_back (i);
+            }
+        }
+            std::exception_ptr
+        error;
+            std::mutex
+        error_mutex;
+            auto
+        pop = [&](std::size_t w, bool own, std::size_t& index)
+        {
+                std::lock_guard
+            lock { queues[w].mutex };
+                auto&
+            tasks = queues[w].tasks;
+            if (tasks.empty ())
+            {
+                return false;
+            }
+            if (own)
+            {
+                index = tasks.back ();
+                tasks.pop_back ();
+            }
+            else
+            {
+                index = tasks.front ();
+                tasks.pop_front ();
+            }
+            return true;
+        };
+            auto
+        work = [&](std::size_t w)
+        {
+                std::size_t
+            index;
+            for (;;)
+            {
+                    bool
+                found = pop (w, true, index);
+                for (std::size_t v = 1; !found && v < workers; ++v)
+                {
+                    found = pop ((w + v) % workers, false, index);
+                }
+                // No task is ever added: when every queue is empty, we are
+                // done.
+                if (!found)
+                {
+                    return;
+                }
+                try
+                {
+                    task (index, w);
+                }
+                catch (...)
+                {
+                        std::lock_guard
+                    lock { error_mutex };
+                    if (!error)
+                    {
+                        error = std::current_exception ();
+                    }
+                }
+            }
+        };
+        {
+                std::lock_guard
+            lock { mutex_m };
+            job_m = work;
+            active_m = workers;
+            pending_m = workers - 1;
+            ++generation_m;
+        }
+        if (workers > 1)
+        {
+            wake_m.notify_all ();
+        }
+            auto
+        outer = std::exchange (running_m, this);
+        work (0);
+        running_m = outer;
+        {
+                std::unique_lock
+            lock { mutex_m };
+            done_m.wait (lock, [&]{ return pending_m == 0; });
+            job_m = nullptr;
+        }
+        if (error)
+        {
+            std::rethrow_exception (error);
+        }
+    }
+};
+
+// A pool per number of threads, shared by the process and kept until it
+// exits: the batches run on it do not start threads of their own.
+    inline work_stealing_pool_t&
+shared_pool (std::size_t threads = 0)
+{
+        static std::mutex
+    mutex;
+        static std::map <std::size_t, std::unique_ptr <work_stealing_pool_t>>
+    pools;
+    if (!threads)
+    {
+        threads = std::max (1u, std::thread::hardware_concurrency ());
+    }
+        std::lock_guard
+    lock { mutex };
+        auto&
+    pool = pools[threads];
+    if (!pool)
+    {
+        pool = std::make_unique <work_stealing_pool_t> (threads);
+    }
+    return *pool;
+}
+
+} // namespace calculisto::json_validator::detail
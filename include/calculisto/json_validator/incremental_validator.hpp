@@ -0,0 +1,547 @@
+#pragma once
+#include "json_validator.hpp"
+
+    namespace
+calculisto::json_validator
+{
+// What the validations of an instance learnt about it: the outcomes of the
+// (sub-schema, instance node) pairs they evaluated, by node address. It is
+// only good for that instance, at that address, for as long as it is only
+// changed by incremental_validator_t::apply_patch ().
+    class
+validation_trace_t
+{
+    friend class incremental_validator_t;
+        const instance_t*
+    instance_m = nullptr;
+        const detail::compiled_schema_t*
+    schema_m = nullptr;
+        detail::trace_t
+    trace_m;
+
+public:
+    // The number of instance nodes with outcomes.
+        std::size_t
+    size () const noexcept
+    {
+        return trace_m.outcomes.size ();
+    }
+};
+
+// Revalidates an instance after RFC 6902 patches:
+//
+//     incremental_validator_t incremental { validator, "http://example.com/config" };
+//     validation_trace_t trace;
+//     incremental.validate (config, trace);
+//     ...
+//     auto result = incremental.apply_patch (config, trace, patch);
+//
+// The outcome of a pair only depends on the sub-tree of its instance node.
+// Applying the patch forgets the outcomes of the nodes it replaces or
+// removes, and of the ancestors of the paths it changes; revalidating then
+// evaluates these nodes again, and reuses the outcomes of the others. The
+// result is the one of a full validation, at the cost of the patched values
+// and of the keywords of their ancestors ("required", "uniqueItems",
+// "contains"... which look at all the members or items of their node).
+// Only successes are reused by the diagnostics: a failing pair is evaluated
+// again, for its errors.
+    class
+incremental_validator_t
+{
+        const validator_t&
+    validator_m;
+        const detail::compiled_schema_t*
+    schema_m;
+        detail::context_t
+    context_m;
+
+        auto
+    evaluate (const instance_t& instance, validation_trace_t& trace)
+        -> validation_result_t
+    {
+        context_m.trace = &trace.trace_m;
+            auto
+        result = validator_m.evaluate_impl (instance, *schema_m, context_m);
+        context_m.trace = nullptr;
+        return result;
+    }
+
+    // The reference tokens of a JSON pointer.
+        static auto
+    tokens (std::string const& pointer)
+        -> std::vector <std::string>
+    {
+            std::vector <std::string>
+        result;
+        if (pointer.empty ())
+        {
+            return result;
+        }
+        if (pointer[0] != '/')
+        {
+            throw (std::runtime_error { fmt::format (
+                  "Invalid JSON pointer \"{}\" in patch."
+                , pointer
+            )});
+        }
+        for (std::size_t i = 0; i < pointer.size (); ++i)
+        {
+            if (pointer[i] == '/')
+            {
+                result.emplace_back ();
+                continue;
+            }
+            if (pointer[i] == '~')
+            {
+                if (i + 1 == pointer.size () || (pointer[i + 1] != '0' && pointer[i + 1] != '1'))
+                {
+                    throw (std::runtime_error { fmt::format (
+                          "Invalid JSON pointer \"{}\" in patch."
+                        , pointer
+                    )});
+                }
+                result.back () += pointer[++i] == '0' ? '~' : '/';
+                continue;
+            }
+            result.back () += pointer[i];
+        }
+        return result;
+    }
+
+    // The JSON pointer of a path, with its last token replaced.
+        static auto
+    pointer (std::vector <std::string> const& path, std::string const& last)
+        -> std::string
+    {
+            std::string
+        result;
+        for (std::size_t i = 0; i < path.size (); ++i)
+        {
+            result += '/';
+            for (auto c: i + 1 == path.size () ? last : path[i])
+            {
+                if (c == '~')
+                {
+                    result += "~0";
+                }
+                else if (c == '/')
+                {
+                    result += "~1";
+                }
+                else
+                {
+                    result += c;
+                }
+            }
+        }
+        return result;
+    }
+
+        static auto
+    patch_operation (std::string op, std::string path)
+        -> json_t
+    {
+        return json_t { { "op", std::move (op) }, { "path", std::move (path) } };
+    }
+
+        static auto
+    patch_operation (std::string op, std::string path, json_t value)
+        -> json_t
+    {
+        return json_t { { "op", std::move (op) }, { "path", std::move (path) }, { "value", std::move (value) } };
+    }
+
+    // The rank an array token designates. "-", past the end, is only valid
+    // where a value is added.
+        static auto
+    rank (json_t::array_t const& array, std::string const& token, bool adding)
+        -> std::size_t
+    {
+        if (adding && token == "-")
+        {
+            return array.size ();
+        }
+            std::size_t
+        r = 0;
+            auto
+        [end, error] = std::from_chars (token.data (), token.data () + token.size (), r);
+        if (
+               token.empty ()
+            || error != std::errc {}
+            || end != token.data () + token.size ()
+            || (token.size () > 1 && token[0] == '0')
+            || r > array.size ()
+            || (r == array.size () && !adding)
+        ){
+            throw (std::runtime_error { fmt::format (
+                  "Invalid array index \"{}\" in patch."
+                , token
+            )});
+        }
+        return r;
+    }
+
+    // The value at the path, without its last token. The outcomes of the
+    // nodes met, ancestors of a value about to change, are forgotten.
+        static auto
+    parent (json_t& instance, std::vector <std::string> const& path, detail::trace_t& trace)
+        -> json_t&
+    {
+            auto
+        node = &instance;
+        for (std::size_t i = 0; i + 1 < path.size (); ++i)
+        {
+            trace.forget (*node);
+            if (node->is_object ())
+            {
+                    auto&
+                object = node->get_object ();
+                    auto
+                member = object.find (path[i]);
+                if (member == object.end ())
+                {
+                    throw (std::runtime_error { fmt::format (
+                          "No member \"{}\" in patched value."
+                        , path[i]
+                    )});
+                }
+                node = &member->second;
+            }
+            else if (node->is_array ())
+            {
+                node = &node->get_array ()[rank (node->get_array (), path[i], false)];
+            }
+            else
+            {
+                throw (std::runtime_error { "Patch path goes through a scalar." });
+            }
+        }
+        trace.forget (*node);
+        return *node;
+    }
+
+        static auto
+    find (const json_t& instance, std::vector <std::string> const& path)
+        -> const json_t&
+    {
+            auto
+        node = &instance;
+        for (auto&& token: path)
+        {
+            if (node->is_object ())
+            {
+                    auto
+                member = node->get_object ().find (token);
+                if (member == node->get_object ().end ())
+                {
+                    throw (std::runtime_error { fmt::format (
+                          "No member \"{}\" in patched value."
+                        , token
+                    )});
+                }
+                node = &member->second;
+            }
+            else if (node->is_array ())
+            {
+                node = &node->get_array ()[rank (node->get_array (), token, false)];
+            }
+            else
+            {
+                throw (std::runtime_error { "Patch path goes through a scalar." });
+            }
+        }
+        return *node;
+    }
+
+    // Runs an edit that inserts (shift 1) or erases (shift -1) the item at
+    // index: the items move, their outcomes follow them. Their own sub-trees
+    // stay where they are.
+        template <typename Edit>
+        static void
+    edit_array (
+          json_t::array_t&   array
+        , std::size_t        index
+        , int                shift
+        , detail::trace_t&   trace
+        , Edit&&             edit
+    ){
+            std::vector <std::pair <std::size_t, std::vector <std::pair <const detail::compiled_schema_t*, bool>>>>
+        moved;
+        for (std::size_t i = 0; i < array.size (); ++i)
+        {
+            if (i == index && shift < 0)
+            {
+                continue;
+            }
+            if (
+                    auto
+                  node = trace.outcomes.extract (&array[i])
+                ; !node.empty ()
+            ){
+                moved.emplace_back (i < index ? i : (shift > 0 ? i + 1 : i - 1), std::move (node.mapped ()));
+            }
+        }
+        edit ();
+        for (auto&& [i, outcomes]: moved)
+        {
+            trace.outcomes[&array[i]] = std::move (outcomes);
+        }
+    }
+
+    // add (), remove () and replace () append to undo the operations that
+    // undo their edits.
+        static void
+    add (
+          json_t&                         instance
+        , std::vector <std::string> const& path
+        , json_t                          value
+        , detail::trace_t&                trace
+        , std::vector <json_t>&           undo
+    ){
+        if (path.empty ())
+        {
+            trace.forget_tree (instance);
+            undo.push_back (patch_operation ("replace", "", std::move (instance)));
+            instance = std::move (value);
+            return;
+        }
+            auto&
+        target = parent (instance, path, trace);
+        if (target.is_object ())
+        {
+                auto&
+            object = target.get_object ();
+            if (
+                    auto
+                  member = object.find (path.back ())
+                ; member != object.end ()
+            ){
+                trace.forget_tree (member->second);
+                undo.push_back (patch_operation ("replace", pointer (path, path.back ()), std::move (member->second)));
+                member->second = std::move (value);
+            }
+            else
+            {
+                object.emplace (path.back (), std::move (value));
+                undo.push_back (patch_operation ("remove", pointer (path, path.back ())));
+            }
+        }
+        else if (target.is_array ())
+        {
+                auto&
+            array = target.get_array ();
+                auto
+            index = rank (array, path.back (), true);
+            edit_array (array, index, 1, trace, [&]
+            {
+                array.insert (array.begin () + static_cast <std::ptrdiff_t> (index), std::move (value));
+            });
+            undo.push_back (patch_operation ("remove", pointer (path, std::to_string (index))));
+        }
+        else
+        {
+            throw (std::runtime_error { "Patch adds a member to a scalar." });
+        }
+    }
+
+        static void
+    remove (
+          json_t&                         instance
+        , std::vector <std::string> const& path
+        , detail::trace_t&                trace
+        , std::vector <json_t>&           undo
+    ){
+        if (path.empty ())
+        {
+            throw (std::runtime_error { "Patch removes the whole document." });
+        }
+            auto&
+        target = parent (instance, path, trace);
+        if (target.is_object ())
+        {
+                auto&
+            object = target.get_object ();
+                auto
+            member = object.find (path.back ());
+            if (member == object.end ())
+            {
+                throw (std::runtime_error { fmt::format (
+                      "No member \"{}\" in patched value."
+                    , path.back ()
+                )});
+            }
+            trace.forget_tree (member->second);
+            undo.push_back (patch_operation ("add", pointer (path, path.back ()), std::move (member->second)));
+            object.erase (member);
+        }
+        else if (target.is_array ())
+        {
+                auto&
+            array = target.get_array ();
+                auto
+            index = rank (array, path.back (), false);
+            trace.forget_tree (array[index]);
+            undo.push_back (patch_operation ("add", pointer (path, std::to_string (index)), std::move (array[index])));
+            edit_array (array, index, -1, trace, [&]
+            {
+                array.erase (array.begin () + static_cast <std::ptrdiff_t> (index));
+            });
+        }
+        else
+        {
+            throw (std::runtime_error { "Patch removes a member of a scalar." });
+        }
+    }
+
+    // The value must be there.
+        static void
+    replace (
+          json_t&                         instance
+        , std::vector <std::string> const& path
+        , json_t                          value
+        , detail::trace_t&                trace
+        , std::vector <json_t>&           undo
+    ){
+        find (instance, path);
+        if (path.empty ())
+        {
+            trace.forget_tree (instance);
+            undo.push_back (patch_operation ("replace", "", std::move (instance)));
+            instance = std::move (value);
+            return;
+        }
+            auto&
+        target = parent (instance, path, trace);
+            auto&
+        node = target.is_object ()
+            ? target.get_object ().find (path.back ())->second
+            : target.get_array ()[rank (target.get_array (), path.back (), false)];
+        trace.forget_tree (node);
+        undo.push_back (patch_operation ("replace", pointer (path, path.back ()), std::move (node)));
+        node = std::move (value);
+    }
+
+    // One RFC 6902 operation.
+        static void
+    apply (json_t& instance, const json_t& operation, detail::trace_t& trace, std::vector <json_t>& undo)
+    {
+            auto const&
+        op = operation.at ("op").get_string ();
+            auto
+        path = tokens (operation.at ("path").get_string ());
+        if (op == "add")
+        {
+            add (instance, path, operation.at ("value"), trace, undo);
+        }
+        else if (op == "remove")
+        {
+            remove (instance, path, trace, undo);
+        }
+        else if (op == "replace")
+        {
+            replace (instance, path, operation.at ("value"), trace, undo);
+        }
+        else if (op == "move" || op == "copy")
+        {
+                auto const&
+            from_pointer = operation.at ("from").get_string ();
+                auto const&
+            path_pointer = operation.at ("path").get_string ();
+                auto
+            from = tokens (from_pointer);
+                json_t
+            value = find (instance, from);
+            if (op == "move")
+            {
+                if (from_pointer == path_pointer)
+                {
+                    return;
+                }
+                if (path_pointer.compare (0, from_pointer.size () + 1, from_pointer + "/") == 0)
+                {
+                    throw (std::runtime_error { fmt::format (
+                          "Patch moves \"{}\" into itself."
+                        , from_pointer
+                    )});
+                }
+                remove (instance, from, trace, undo);
+            }
+            add (instance, path, std::move (value), trace, undo);
+        }
+        else if (op == "test")
+        {
+            if (find (instance, path) != operation.at ("value"))
+            {
+                throw (std::runtime_error { fmt::format (
+                      "Patch test of \"{}\" failed."
+                    , operation.at ("path").get_string ()
+                )});
+            }
+        }
+        else
+        {
+            throw (std::runtime_error { fmt::format (
+                  "Unknown patch operation \"{}\"."
+                , op
+            )});
+        }
+    }
+
+public:
+    // The validator must outlive this object.
+    incremental_validator_t (const validator_t& validator, std::string const& schema_uri = "")
+        : validator_m { validator }
+        , schema_m    { &validator.find_schema (schema_uri) }
+    {}
+
+    // Validates the whole instance, and keeps in the trace what its
+    // revalidations reuse.
+        auto
+    validate (const instance_t& instance, validation_trace_t& trace)
+        -> validation_result_t
+    {
+        trace.trace_m.outcomes.clear ();
+        trace.instance_m = &instance;
+        trace.schema_m = schema_m;
+        return evaluate (instance, trace);
+    }
+
+    // Applies an RFC 6902 patch (an array of operations) to the instance the
+    // trace was made for, and revalidates it. The patch is applied as a
+    // whole or not at all: if an operation fails, the ones before it are
+    // undone and the exception is rethrown, with the instance as it was and
+    // the trace still good for it.
+        auto
+    apply_patch (instance_t& instance, validation_trace_t& trace, const json_t& patch)
+        -> validation_result_t
+    {
+        if (trace.instance_m != &instance || trace.schema_m != schema_m)
+        {
+            throw (std::runtime_error { "The trace was not made for this instance and schema." });
+        }
+            std::vector <json_t>
+        undo;
+        try
+        {
+            for (auto&& operation: patch.get_array ())
+            {
+                apply (instance, operation, trace.trace_m, undo);
+            }
+        }
+        catch (...)
+        {
+            // The undoing edits forget outcomes like the others: the trace
+            // only loses what it knew of the nodes they touch.
+                std::vector <json_t>
+            redo;
+            for (auto i = undo.rbegin (); i != undo.rend (); ++i)
+            {
+                apply (instance, *i, trace.trace_m, redo);
+            }
+            throw;
+        }
+        return evaluate (instance, trace);
+    }
+};
+
+} // namespace calculisto::json_validator
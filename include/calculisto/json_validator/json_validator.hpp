@@ -1,15 +1,28 @@
 #pragma once
 #include "detail/draft-07-schema.hpp"
+#include "detail/formats.hpp"
+#include "detail/simd.hpp"
+#include "detail/thread_pool.hpp"
 
 #include <tao/json.hpp>
 #include <calculisto/uri/uri.hpp>
 
 #include <fmt/ranges.h>
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <iterator>
+#include <limits>
+#include <optional>
 #include <regex>
 #include <unordered_map>
 #include <unordered_set>
-#include <set>
 
 // Make tao::json::value printable.
     template <>
@@ -52,646 +65,3765 @@ uri_t = calculisto::uri::uri_t;
     namespace
 detail // {{{
 {
-        bool
-    type_match (const json_t& schema, const json_t& instance)
+    // The keywords understood by the validator. Their position is their bit
+    // in compiled_schema_t::keywords.
+        enum
+    keyword_t
+        : std::uint8_t
     {
-            auto
-        string = schema.get_string ();
-        if (string == "null")    { return instance.is_null        (); }
-        if (string == "boolean") { return instance.is_boolean     (); }
-        if (string == "object")  { return instance.is_object      (); }
-        if (string == "array")   { return instance.is_array       (); }
-        if (string == "number")  { return instance.is_number      (); }
-        if (string == "string")  { return instance.is_string_type (); }
-        if (string == "integer") { return instance.is_integer     (); }
-        throw std::runtime_error ("internal error");
-    }
-} // }}} namespace detail
+          kw_ref
+        , kw_all_of
+        , kw_any_of
+        , kw_one_of
+        , kw_not
+        , kw_if
+        , kw_then
+        , kw_else
+        , kw_type
+        , kw_enum
+        , kw_const
+        , kw_dependencies
+        , kw_dependent_schemas
+        , kw_properties
+        , kw_pattern_properties
+        , kw_additional_properties
+        , kw_property_names
+        , kw_max_properties
+        , kw_min_properties
+        , kw_required
+        , kw_dependent_required
+        , kw_items
+        , kw_additional_items
+        , kw_contains
+        , kw_max_contains
+        , kw_min_contains
+        , kw_max_items
+        , kw_min_items
+        , kw_unique_items
+        , kw_multiple_of
+        , kw_maximum
+        , kw_exclusive_maximum
+        , kw_minimum
+        , kw_exclusive_minimum
+        , kw_max_length
+        , kw_min_length
+        , kw_pattern
+        , kw_format
+        , kw_content_encoding
+        , kw_content_media_type
+        , kw_count
+    };
 
-    class
-validator_t
-{
-private: 
-        std::set <schema_t>
-    schemas_m;
-        const schema_t*
-    last_schema_m = nullptr;
-        const schema_t*
-    meta_schema_m = nullptr;
-        std::unordered_map <std::string, const schema_t*>
-    registered_schemas_m;
-        std::unordered_map <const json_t*, const schema_t*>
-    registered_references_m;
-        std::unordered_set <const schema_t*>
-    analysed_schemas_m;
+    // Where the value of a key of a schema holds sub-schemas.
+        enum
+    subschema_kind_t
+        : std::uint8_t
+    {
+          holds_none
+        , holds_schema
+        , holds_object_of_schemas
+        , holds_array_of_schemas
+        // items: a schema or an array of schemas.
+        , holds_schema_or_array
+        // dependencies: schemas or arrays of property names.
+        , holds_dependencies
+    };
 
-        auto
-    add_meta_schema () 
-        -> const schema_t*
+        struct
+    keyword_entry_t
     {
-            auto&&
-        [ it, inserted ] = schemas_m.insert (
-            tao::json::from_string (detail::draft_07_schema)
-        );
-            auto const&
-        schema = *it;
-        if (inserted)
+            std::string_view
+        name;
+        // kw_count for the keys that do not validate.
+            keyword_t
+        keyword;
+            subschema_kind_t
+        kind;
+    };
+
+    // The keys of a schema that the analysis and the compilation know of. The
+    // keywords come first, in their order.
+        inline constexpr std::array <keyword_entry_t, kw_count + 2>
+    keyword_table = {{
+          { "$ref",                 kw_ref,                    holds_none }
+        , { "allOf",                kw_all_of,                 holds_array_of_schemas }
+        , { "anyOf",                kw_any_of,                 holds_array_of_schemas }
+        , { "oneOf",                kw_one_of,                 holds_array_of_schemas }
+        , { "not",                  kw_not,                    holds_schema }
+        , { "if",                   kw_if,                     holds_schema }
+        , { "then",                 kw_then,                   holds_schema }
+        , { "else",                 kw_else,                   holds_schema }
+        , { "type",                 kw_type,                   holds_none }
+        , { "enum",                 kw_enum,                   holds_none }
+        , { "const",                kw_const,                  holds_none }
+        , { "dependencies",         kw_dependencies,           holds_dependencies }
+        , { "dependentSchemas",     kw_dependent_schemas,      holds_object_of_schemas }
+        , { "properties",           kw_properties,             holds_object_of_schemas }
+        , { "patternProperties",    kw_pattern_properties,     holds_object_of_schemas }
+        , { "additionalProperties", kw_additional_properties,  holds_schema }
+        , { "propertyNames",        kw_property_names,         holds_schema }
+        , { "maxProperties",        kw_max_properties,         holds_none }
+        , { "minProperties",        kw_min_properties,         holds_none }
+        , { "required",             kw_required,               holds_none }
+        , { "dependentRequired",    kw_dependent_required,     holds_none }
+        , { "items",                kw_items,                  holds_schema_or_array }
+        , { "additionalItems",      kw_additional_items,       holds_schema }
+        , { "contains",             kw_contains,               holds_schema }
+        , { "maxContains",          kw_max_contains,           holds_none }
+        , { "minContains",          kw_min_contains,           holds_none }
+        , { "maxItems",             kw_max_items,              holds_none }
+        , { "minItems",             kw_min_items,              holds_none }
+        , { "uniqueItems",          kw_unique_items,           holds_none }
+        , { "multipleOf",           kw_multiple_of,            holds_none }
+        , { "maximum",              kw_maximum,                holds_none }
+        , { "exclusiveMaximum",     kw_exclusive_maximum,      holds_none }
+        , { "minimum",              kw_minimum,                holds_none }
+        , { "exclusiveMinimum",     kw_exclusive_minimum,      holds_none }
+        , { "maxLength",            kw_max_length,             holds_none }
+        , { "minLength",            kw_min_length,             holds_none }
+        , { "pattern",              kw_pattern,                holds_none }
+        , { "format",               kw_format,                 holds_none }
+        , { "contentEncoding",      kw_content_encoding,       holds_none }
+        , { "contentMediaType",     kw_content_media_type,     holds_none }
+        , { "$defs",                kw_count,                  holds_object_of_schemas }
+        , { "definitions",          kw_count,                  holds_object_of_schemas }
+    }};
+
+    // The spelling of each keyword, by position.
+        inline constexpr auto
+    keyword_names = []
+    {
+            std::array <std::string_view, kw_count>
+        names {};
+        for (std::size_t i = 0; i < kw_count; ++i)
         {
-            meta_schema_m = &schema;
+            names[i] = keyword_table[i].name;
         }
-        register_schema (schema, "http://json-schema.org/draft-07/schema");
-        analyse (
-              schema
-            , "http://json-schema.org/draft-07/schema"
-        );
-        return &schema;
+        return names;
+    } ();
+
+        inline constexpr std::size_t
+    keyword_hash (std::string_view name) noexcept
+    {
+        return name.empty ()
+            ? 0
+            : (name.size () * 7
+                + static_cast <unsigned char> (name.front ()) * 3
+                + static_cast <unsigned char> (name.back ())) % 128;
     }
 
-        auto
-    add_schema_impl (json_t const& json, uri_t const& document_uri)
-        -> const schema_t*
+    // An open addressing table of the indexes into keyword_table, built at
+    // compile time: a lookup is a hash and, most of the time, one comparison.
+        inline constexpr auto
+    keyword_slots = []
     {
-            auto&&
-        [ it_schema, inserted ] = schemas_m.insert (json);
-        if (inserted)
+            std::array <std::uint8_t, 128>
+        slots {};
+        slots.fill (0xff);
+        for (std::size_t i = 0; i < keyword_table.size (); ++i)
         {
-            register_schema (*it_schema, document_uri);
-            analyse (
-                  *it_schema
-                , document_uri
-            );
+                auto
+            h = keyword_hash (keyword_table[i].name);
+            while (slots[h] != 0xff)
+            {
+                h = (h + 1) % slots.size ();
+            }
+            slots[h] = static_cast <std::uint8_t> (i);
+        }
+        return slots;
+    } ();
 
+    // The entry of a key, with kw_count and holds_none for an unknown one.
+        inline constexpr auto
+    find_keyword (std::string_view name) noexcept
+        -> keyword_entry_t
+    {
+        for (
+              auto h = keyword_hash (name)
+            ; keyword_slots[h] != 0xff
+            ; h = (h + 1) % keyword_slots.size ()
+        ){
+            if (keyword_table[keyword_slots[h]].name == name)
+            {
+                return keyword_table[keyword_slots[h]];
+            }
         }
-        return &*it_schema;
+        return { name, kw_count, holds_none };
     }
 
-        auto
-    add_schema_impl (json_t&& json, uri_t const& document_uri)
-        -> const schema_t*
+    static_assert ([]
     {
-            auto&&
-        [ it_schema, inserted ] = schemas_m.insert (std::move (json));
-        if (inserted)
+        for (std::size_t i = 0; i < keyword_table.size (); ++i)
         {
-            register_schema (*it_schema, document_uri);
-            analyse (
-                  *it_schema
-                , document_uri
-            );
+            if (
+                   (i < kw_count && keyword_table[i].keyword != i)
+                || find_keyword (keyword_table[i].name).keyword != keyword_table[i].keyword
+            ){
+                return false;
+            }
         }
-        return &*it_schema;
+        return find_keyword ("title").keyword == kw_count
+            && find_keyword ("").keyword == kw_count;
+    } ());
+
+    // The JSON Schema primitive types, as bits.
+        enum
+    type_mask_t
+        : std::uint8_t
+    {
+          type_null    = 1 << 0
+        , type_boolean = 1 << 1
+        , type_object  = 1 << 2
+        , type_array   = 1 << 3
+        , type_number  = 1 << 4
+        , type_string  = 1 << 5
+        , type_integer = 1 << 6
+    };
+
+        inline std::uint8_t
+    type_mask (std::string const& name)
+    {
+        if (name == "null")    { return type_null;    }
+        if (name == "boolean") { return type_boolean; }
+        if (name == "object")  { return type_object;  }
+        if (name == "array")   { return type_array;   }
+        if (name == "number")  { return type_number;  }
+        if (name == "string")  { return type_string;  }
+        if (name == "integer") { return type_integer; }
+        throw (std::runtime_error { fmt::format (
+              "Unknown type \"{}\" in schema."
+            , name
+        )});
     }
 
-        auto
-    register_schema (schema_t const& schema, uri_t const& uri)
-        -> void
+    // The bits of the types an instance is a member of.
+        inline std::uint8_t
+    type_mask (const json_t& instance)
     {
-        registered_schemas_m[uri.string ()] = &schema;
+        switch (instance.type ())
+        {
+            case tao::json::type::NULL_:
+                return type_null;
+            case tao::json::type::BOOLEAN:
+                return type_boolean;
+            case tao::json::type::OBJECT:
+                return type_object;
+            case tao::json::type::ARRAY:
+                return type_array;
+            case tao::json::type::SIGNED:
+            case tao::json::type::UNSIGNED:
+                return type_number | type_integer;
+            case tao::json::type::DOUBLE:
+                return type_number;
+            default:
+                return instance.is_string_type () ? type_string : 0;
+        }
     }
 
-        auto
-    register_reference (json_t const& reference, schema_t const& schema)
-        -> void
+    // Finalizer of splitmix64.
+        inline constexpr std::uint64_t
+    mix_hash (std::uint64_t h) noexcept
     {
-        registered_references_m[&reference] = &schema;
+        h ^= h >> 30;
+        h *= 0xbf58476d1ce4e5b9;
+        h ^= h >> 27;
+        h *= 0x94d049bb133111eb;
+        h ^= h >> 31;
+        return h;
     }
 
-        auto
-    resolve_reference (uri_t const& target)
-        -> std::pair <const schema_t*, uri_t>
+    // The steps of the hash of an array, and of an object, whose members are
+    // combined regardless of their order.
+        inline constexpr std::uint64_t
+    combine_item (std::uint64_t h, std::uint64_t item) noexcept
     {
-            auto
-        absolute = target.absolute ();
-        if ( 
-                auto&& 
-              i = registered_schemas_m.find (absolute)
-            ; i != registered_schemas_m.end ()
-        ){
-                auto&
-            root_schema = i->second;
-            try
+        return mix_hash (h * 31 + item);
+    }
+
+        inline std::uint64_t
+    combine_member (std::uint64_t h, std::string_view key, std::uint64_t member) noexcept
+    {
+        return h + mix_hash (std::hash <std::string_view> {} (key) ^ (member * 0x9e3779b97f4a7c15));
+    }
+
+    // A hash consistent with the equality of JSON Schema (and of json_t):
+    // numbers are hashed by their value as a double, so that 1 and 1.0 hash
+    // alike, and the members of an object are combined regardless of their
+    // order.
+        inline std::uint64_t
+    hash_value (const json_t& value)
+    {
+        switch (value.type ())
+        {
+            case tao::json::type::NULL_:
+                return mix_hash (1);
+            case tao::json::type::BOOLEAN:
+                return mix_hash (2 + value.get_boolean ());
+            case tao::json::type::SIGNED:
+            case tao::json::type::UNSIGNED:
+            case tao::json::type::DOUBLE:
             {
-                    tao::json::pointer
-                pointer { uri::decode_percent (target.fragment ()) };
-                return { &(root_schema->at (pointer)), absolute };
+                    auto
+                d = value.as <double> ();
+                if (d == 0)
+                {
+                    // -0.0 == 0.0
+                    d = 0;
+                }
+                    std::uint64_t
+                bits;
+                std::memcpy (&bits, &d, sizeof bits);
+                return mix_hash (bits ^ 0x6e756d626572);
             }
-            catch (std::exception const& e)
+            case tao::json::type::ARRAY:
             {
-                throw (std::runtime_error { fmt::format (
-                      "{}:{}: Resolution of pointer {} in schema {} failed: {}."
-                    , __FILE__
-                    , __LINE__
-                    , target.fragment ()
-                    , absolute.string ()
-                    , e.what ()
-                )});
-            }      
+                    std::uint64_t
+                h = mix_hash (4);
+                for (auto&& i: value.get_array ())
+                {
+                    h = combine_item (h, hash_value (i));
+                }
+                return h;
+            }
+            case tao::json::type::OBJECT:
+            {
+                    std::uint64_t
+                h = mix_hash (5);
+                for (auto&& [k, v]: value.get_object ())
+                {
+                    h = combine_member (h, k, hash_value (v));
+                }
+                return h;
+            }
+            default:
+                if (value.is_string_type ())
+                {
+                    return mix_hash (std::hash <std::string_view> {} (value.get_string_type ()));
+                }
+                return mix_hash (6);
         }
-        throw (std::runtime_error { fmt::format (
-              "Couldn't resolve reference {}."
-            , target.string ()
-        )});
     }
 
-        auto
-    resolve_reference (std::string const& ref, uri_t const& base_uri)
-        -> std::pair <const schema_t*, uri_t>
+    // The hash of a sub-schema, and whether it is closed: without "$ref" nor
+    // "$id", its meaning does not depend on where it is, and it can be
+    // shared with any equal sub-schema.
+        struct
+    subtree_t
+    {
+            std::uint64_t
+        hash;
+            bool
+        closed;
+    };
+
+        using
+    subtree_index_t = std::unordered_map <const json_t*, subtree_t>;
+
+    // Indexes the objects of a document, bottom-up, in one pass. The hashes
+    // are those of hash_value ().
+        inline subtree_t
+    index_subtrees (const json_t& value, subtree_index_t& index)
+    {
+        if (value.is_array ())
+        {
+                subtree_t
+            t { mix_hash (4), true };
+            for (auto&& i: value.get_array ())
+            {
+                    auto
+                u = index_subtrees (i, index);
+                t.hash = combine_item (t.hash, u.hash);
+                t.closed = t.closed && u.closed;
+            }
+            return t;
+        }
+        if (value.is_object ())
+        {
+                subtree_t
+            t { mix_hash (5), true };
+            for (auto&& [k, v]: value.get_object ())
+            {
+                    auto
+                u = index_subtrees (v, index);
+                t.hash = combine_member (t.hash, k, u.hash);
+                t.closed = t.closed && u.closed && k != "$ref" && k != "$id";
+            }
+            index.emplace (&value, t);
+            return t;
+        }
+        return { hash_value (value), true };
+    }
+
+    // Whether two items of the array are equal. The items are hashed once and
+    // their addresses are put in an open addressing table, with linear
+    // probing: expected linear time, and nothing is copied.
+        inline bool
+    has_duplicates (const json_t::array_t& array)
+    {
+        if (array.size () < 2)
+        {
+            return false;
+        }
+            std::size_t
+        capacity = 4;
+        while (capacity < 2 * array.size ())
+        {
+            capacity *= 2;
+        }
+            std::vector <std::pair <std::uint64_t, const json_t*>>
+        slots (capacity);
+        for (auto&& i: array)
+        {
+                auto
+            h = hash_value (i);
+            for (auto slot = h & (capacity - 1); ; slot = (slot + 1) & (capacity - 1))
+            {
+                    auto&
+                [slot_hash, item] = slots[slot];
+                if (!item)
+                {
+                    slot_hash = h;
+                    item = &i;
+                    break;
+                }
+                if (slot_hash == h && *item == i)
+                {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    // A set of JSON values, bucketed by type, for the membership tests of
+    // "enum". Strings, integers and other numbers live in hash sets,
+    // containers are indexed by their structural hash. Looking a value up
+    // allocates nothing. The values must outlive the set.
+        class
+    value_set_t
+    {
+            bool
+        null_m = false;
+            bool
+        true_m = false;
+            bool
+        false_m = false;
+            std::unordered_set <std::string_view>
+        strings_m;
+        // Integral numbers, whatever their representation: 1 and 1.0 are
+        // the same member.
+            std::unordered_set <std::int64_t>
+        integers_m;
+        // Integers beyond the range of std::int64_t.
+            std::unordered_set <std::uint64_t>
+        large_integers_m;
+            std::unordered_set <double>
+        doubles_m;
+            std::unordered_multimap <std::uint64_t, const json_t*>
+        containers_m;
+
+        // Calls one of the functions with the canonical form of a number.
+            template <typename Integer, typename Large, typename Double>
+            static auto
+        visit_number (const json_t& number, Integer&& integer, Large&& large, Double&& dbl)
+        {
+                constexpr auto
+            two_63 = 9223372036854775808.0;
+            switch (number.type ())
+            {
+                case tao::json::type::SIGNED:
+                    return integer (number.get_signed ());
+                case tao::json::type::UNSIGNED:
+                {
+                        auto
+                    u = number.get_unsigned ();
+                    if (u <= static_cast <std::uint64_t> (std::numeric_limits <std::int64_t>::max ()))
+                    {
+                        return integer (static_cast <std::int64_t> (u));
+                    }
+                    return large (u);
+                }
+                default:
+                {
+                        auto
+                    d = number.get_double ();
+                    if (std::trunc (d) == d && d >= -two_63 && d < 2 * two_63)
+                    {
+                        if (d < two_63)
+                        {
+                            return integer (static_cast <std::int64_t> (d));
+                        }
+                        return large (static_cast <std::uint64_t> (d));
+                    }
+                    return dbl (d);
+                }
+            }
+        }
+
+    public:
+            void
+        insert (const json_t& value)
+        {
+            switch (value.type ())
+            {
+                case tao::json::type::NULL_:
+                    null_m = true;
+                    return;
+                case tao::json::type::BOOLEAN:
+                    (value.get_boolean () ? true_m : false_m) = true;
+                    return;
+                case tao::json::type::SIGNED:
+                case tao::json::type::UNSIGNED:
+                case tao::json::type::DOUBLE:
+                    visit_number (
+                          value
+                        , [&](std::int64_t i)  { integers_m.insert (i); }
+                        , [&](std::uint64_t u) { large_integers_m.insert (u); }
+                        , [&](double d)        { doubles_m.insert (d); }
+                    );
+                    return;
+                case tao::json::type::ARRAY:
+                case tao::json::type::OBJECT:
+                    containers_m.emplace (hash_value (value), &value);
+                    return;
+                default:
+                    if (value.is_string_type ())
+                    {
+                        strings_m.insert (value.get_string_type ());
+                    }
+            }
+        }
+
+            bool
+        contains (const json_t& value) const
+        {
+            switch (value.type ())
+            {
+                case tao::json::type::NULL_:
+                    return null_m;
+                case tao::json::type::BOOLEAN:
+                    return value.get_boolean () ? true_m : false_m;
+                case tao::json::type::SIGNED:
+                case tao::json::type::UNSIGNED:
+                case tao::json::type::DOUBLE:
+                    return visit_number (
+                          value
+                        , [&](std::int64_t i)  { return integers_m.count (i) > 0; }
+                        , [&](std::uint64_t u) { return large_integers_m.count (u) > 0; }
+                        , [&](double d)        { return doubles_m.count (d) > 0; }
+                    );
+                case tao::json::type::ARRAY:
+                case tao::json::type::OBJECT:
+                {
+                    if (containers_m.empty ())
+                    {
+                        return false;
+                    }
+                        auto
+                    [first, last] = containers_m.equal_range (hash_value (value));
+                    return std::any_of (first, last, [&](auto&& i) { return *i.second == value; });
+                }
+                default:
+                    return value.is_string_type ()
+                        && strings_m.count (value.get_string_type ()) > 0;
+            }
+        }
+    };
+
+    // A numeric keyword operand, decoded once.
+        struct
+    number_t
+    {
+            tao::json::type
+        kind = tao::json::type::SIGNED;
+            union
+        {
+                std::int64_t
+            signed_value;
+                std::uint64_t
+            unsigned_value;
+                double
+            double_value = 0;
+        };
+
+            static number_t
+        from (const json_t& value)
+        {
+                number_t
+            n;
+            n.kind = value.type ();
+            switch (n.kind)
+            {
+                case tao::json::type::SIGNED:
+                    n.signed_value = value.get_signed ();
+                    break;
+                case tao::json::type::UNSIGNED:
+                    n.unsigned_value = value.get_unsigned ();
+                    break;
+                case tao::json::type::DOUBLE:
+                    n.double_value = value.get_double ();
+                    break;
+                default:
+                    throw (std::runtime_error { fmt::format (
+                          "Schema value {} is not a number."
+                        , tao::json::to_string (value)
+                    )});
+            }
+            return n;
+        }
+    };
+
+    // Three way comparison of a numeric instance with an operand, with the
+    // same semantic as tao::json::value comparisons.
+        inline int
+    compare (const json_t& instance, const number_t& n)
     {
             auto
-        target = base_uri.resolve (ref);
-        if (
-                auto&& 
-              i = registered_schemas_m.find (target)
-            ; i != registered_schemas_m.end ()
-        ){
-            return { i->second, base_uri };
+        cmp = [](auto a, auto b) { return a < b ? -1 : (b < a ? 1 : 0); };
+        switch (instance.type ())
+        {
+            case tao::json::type::SIGNED:
+            {
+                    auto
+                a = instance.get_signed ();
+                switch (n.kind)
+                {
+                    case tao::json::type::SIGNED:
+                        return cmp (a, n.signed_value);
+                    case tao::json::type::UNSIGNED:
+                        return a < 0 ? -1 : cmp (static_cast <std::uint64_t> (a), n.unsigned_value);
+                    default:
+                        return cmp (static_cast <double> (a), n.double_value);
+                }
+            }
+            case tao::json::type::UNSIGNED:
+            {
+                    auto
+                a = instance.get_unsigned ();
+                switch (n.kind)
+                {
+                    case tao::json::type::SIGNED:
+                        return n.signed_value < 0 ? 1 : cmp (a, static_cast <std::uint64_t> (n.signed_value));
+                    case tao::json::type::UNSIGNED:
+                        return cmp (a, n.unsigned_value);
+                    default:
+                        return cmp (static_cast <double> (a), n.double_value);
+                }
+            }
+            default:
+            {
+                    auto
+                a = instance.get_double ();
+                switch (n.kind)
+                {
+                    case tao::json::type::SIGNED:
+                        return cmp (a, static_cast <double> (n.signed_value));
+                    case tao::json::type::UNSIGNED:
+                        return cmp (a, static_cast <double> (n.unsigned_value));
+                    default:
+                        return cmp (a, n.double_value);
+                }
+            }
         }
-        return resolve_reference (target);
     }
 
-        void
-    analyse (schema_t const& schema, uri_t const& current_base_uri)
+    // A non-negative integer keyword operand ("maxItems", "minLength"...).
+        inline std::uint64_t
+    count_from (const json_t& value)
     {
-        if (schema.is_boolean ()) return; 
-        if (!schema.is_object ())
+        if (value.is_double ())
         {
+                auto
+            d = value.get_double ();
+            if (d >= 0 && d == std::floor (d))
+            {
+                return static_cast <std::uint64_t> (d);
+            }
             throw (std::runtime_error { fmt::format (
-                  "{}:{}: Schema \"{}\" is not an object."
-                , __FILE__
-                , __LINE__
-                , to_string (schema)
+                  "Schema value {} is not a non-negative integer."
+                , tao::json::to_string (value)
             )});
         }
-        analysed_schemas_m.insert (&schema);
-            auto const&
-        schema_object = schema.get_object ();
-            auto
-        base_uri = current_base_uri;
-            json_t::object_t::const_iterator
-        it;
-        if (
-              it = schema_object.find ("$id")
-            ; it != schema_object.end ()
-        ){
-                auto&
-            id = it->second.get_string ();
-            base_uri = base_uri.resolve (id);
-            register_schema (schema, base_uri);
+        return value.get_unsigned ();
+    }
+
+    // Compare the length of a string, in code points, with "maxLength" and
+    // "minLength". A code point is 1 to 4 bytes: the byte length alone often
+    // decides, and the code points are only counted when it does not.
+        inline bool
+    longer_than (std::string_view text, std::uint64_t max_length) noexcept
+    {
+        if (text.size () <= max_length)
+        {
+            return false;
+        }
+        if ((text.size () + 3) / 4 > max_length)
+        {
+            return true;
+        }
+        return simd::code_points (text.data (), text.size ()) > max_length;
+    }
+
+        inline bool
+    shorter_than (std::string_view text, std::uint64_t min_length) noexcept
+    {
+        if (text.size () < min_length)
+        {
+            return true;
+        }
+        if ((text.size () + 3) / 4 >= min_length)
+        {
+            return false;
+        }
+        return simd::code_points (text.data (), text.size ()) < min_length;
+    }
+
+        struct
+    compiled_schema_t;
+
+        using
+    compiled_schema_ptr = const compiled_schema_t*;
+
+    // A "oneOf" or "anyOf" whose branches all require a property and pin it
+    // to strings, with "const" or "enum". A branch can only hold for an
+    // object whose property has one of its strings.
+        struct
+    discriminator_t
+    {
+            const std::string*
+        property = nullptr;
+            std::unordered_map <std::string_view, std::vector <std::size_t>>
+        branches;
+    };
+
+    // Either the array or the schema form of a "dependencies" entry.
+        struct
+    dependency_t
+    {
+            const std::string*
+        property = nullptr;
+            std::vector <std::string_view>
+        required;
+            compiled_schema_ptr
+        schema = nullptr;
+    };
+
+        struct
+    dependent_required_t
+    {
+            const std::string*
+        property = nullptr;
+            std::vector <std::string_view>
+        required;
+    };
+
+        struct
+    pattern_property_t
+    {
+            const std::string*
+        pattern = nullptr;
+            const std::regex*
+        regex = nullptr;
+            compiled_schema_ptr
+        schema = nullptr;
+    };
+
+    // An "items" sub-schema that only checks numbers against constant
+    // operands, in the form of the bulk check of numeric arrays.
+        struct
+    numeric_items_t
+    {
+            simd::range_t
+        range;
+        // "type" allows integers, but not numbers.
+            bool
+        integer_only = false;
+        // 0 without "multipleOf".
+            double
+        multiple_of = 0;
+    };
+
+    // A sub-schema, compiled: which keywords are present and their decoded
+    // operands. Nothing here is looked up by name during validation.
+        struct
+    compiled_schema_t
+    {
+            const schema_t*
+        schema = nullptr;
+            std::uint64_t
+        keywords = 0;
+        // Boolean schema.
+            bool
+        is_boolean = false;
+            bool
+        boolean_value = true;
+        // Applicators.
+            compiled_schema_ptr
+        ref = nullptr;
+            const json_t*
+        ref_value = nullptr;
+            std::vector <compiled_schema_ptr>
+        all_of;
+            std::vector <compiled_schema_ptr>
+        any_of;
+            std::vector <compiled_schema_ptr>
+        one_of;
+            const discriminator_t*
+        any_of_discriminator = nullptr;
+            const discriminator_t*
+        one_of_discriminator = nullptr;
+            compiled_schema_ptr
+        not_schema = nullptr;
+            compiled_schema_ptr
+        if_schema = nullptr;
+            compiled_schema_ptr
+        then_schema = nullptr;
+            compiled_schema_ptr
+        else_schema = nullptr;
+        // Any instance type.
+            std::uint8_t
+        type = 0;
+            const json_t*
+        type_value = nullptr;
+            const json_t::array_t*
+        enum_values = nullptr;
+            const value_set_t*
+        enum_set = nullptr;
+            const json_t*
+        const_value = nullptr;
+        // Objects.
+            std::vector <dependency_t>
+        dependencies;
+            std::vector <std::pair <const std::string*, compiled_schema_ptr>>
+        dependent_schemas;
+            std::unordered_map <std::string_view, compiled_schema_ptr>
+        properties;
+            std::vector <pattern_property_t>
+        pattern_properties;
+            compiled_schema_ptr
+        additional_properties = nullptr;
+            compiled_schema_ptr
+        property_names = nullptr;
+            std::uint64_t
+        max_properties = 0;
+            std::uint64_t
+        min_properties = 0;
+            std::vector <const std::string*>
+        required;
+            std::unordered_map <std::string_view, std::vector <std::string_view>>
+        dependent_required;
+        // Arrays.
+            bool
+        items_is_array = false;
+            compiled_schema_ptr
+        items = nullptr;
+            std::vector <compiled_schema_ptr>
+        items_array;
+            compiled_schema_ptr
+        additional_items = nullptr;
+            compiled_schema_ptr
+        contains = nullptr;
+            std::uint64_t
+        max_contains = 0;
+            std::uint64_t
+        min_contains = 0;
+            std::uint64_t
+        max_items = 0;
+            std::uint64_t
+        min_items = 0;
+            bool
+        unique_items = false;
+            std::optional <numeric_items_t>
+        numeric_items;
+        // Numbers.
+            double
+        multiple_of = 0;
+            number_t
+        maximum;
+            number_t
+        exclusive_maximum;
+            number_t
+        minimum;
+            number_t
+        exclusive_minimum;
+        // Strings.
+            std::uint64_t
+        max_length = 0;
+            std::uint64_t
+        min_length = 0;
+            const std::string*
+        pattern = nullptr;
+            const std::regex*
+        pattern_regex = nullptr;
+            formats::format_t
+        format = formats::format_t::unknown;
+
+            bool
+        has (keyword_t keyword) const noexcept
+        {
+            return keywords & (std::uint64_t { 1 } << keyword);
+        }
+
+            void
+        set (keyword_t keyword) noexcept
+        {
+            keywords |= std::uint64_t { 1 } << keyword;
+        }
+    };
+
+    // The arrays from which the items are checked in bulk.
+        inline constexpr std::size_t
+    bulk_check_minimum = 16;
+
+    // The numeric_items_t of a sub-schema, if the bulk check can take it:
+    // its keywords are those of numbers, and its bounds are exact doubles.
+        inline auto
+    numeric_items (compiled_schema_t const& schema)
+        -> std::optional <numeric_items_t>
+    {
+            constexpr auto
+        allowed = []
+        {
+                std::uint64_t
+            bits = 0;
+            for (auto keyword: { 
+                  kw_type, kw_multiple_of, kw_maximum, kw_exclusive_maximum
+                , kw_minimum, kw_exclusive_minimum, kw_format
+                , kw_content_encoding, kw_content_media_type
+            }){
+                bits |= std::uint64_t { 1 } << keyword;
+            }
+            return bits;
+        } ();
+        if (schema.is_boolean || (schema.keywords & ~allowed))
+        {
+            return std::nullopt;
+        }
+            numeric_items_t
+        result;
+        if (schema.has (kw_type))
+        {
+            if (!(schema.type & (type_number | type_integer)))
+            {
+                return std::nullopt;
+            }
+            result.integer_only = !(schema.type & type_number);
+        }
+        if (schema.has (kw_multiple_of))
+        {
+            if (!(schema.multiple_of > 0) || !std::isfinite (schema.multiple_of))
+            {
+                return std::nullopt;
+            }
+            result.multiple_of = schema.multiple_of;
+        }
+        // Integers beyond 2^53 are compared exactly with integer instances:
+        // as doubles, they would not.
+            auto
+        bound = [](number_t const& n, double& b)
+        {
+                constexpr auto
+            exact = std::uint64_t { 1 } << 53;
+            switch (n.kind)
+            {
+                case tao::json::type::SIGNED:
+                    if (n.signed_value < -static_cast <std::int64_t> (exact) || n.signed_value > static_cast <std::int64_t> (exact))
+                    {
+                        return false;
+                    }
+                    b = static_cast <double> (n.signed_value);
+                    return true;
+                case tao::json::type::UNSIGNED:
+                    if (n.unsigned_value > exact)
+                    {
+                        return false;
+                    }
+                    b = static_cast <double> (n.unsigned_value);
+                    return true;
+                default:
+                    b = n.double_value;
+                    return true;
+            }
+        };
+        if (
+               (schema.has (kw_maximum) && !bound (schema.maximum, result.range.maximum))
+            || (schema.has (kw_exclusive_maximum) && !bound (schema.exclusive_maximum, result.range.exclusive_maximum))
+            || (schema.has (kw_minimum) && !bound (schema.minimum, result.range.minimum))
+            || (schema.has (kw_exclusive_minimum) && !bound (schema.exclusive_minimum, result.range.exclusive_minimum))
+        ){
+            return std::nullopt;
+        }
+        return result;
+    }
+
+    // Checks the items of an array against a numeric_items_t, by blocks of
+    // 64: the integers within 2^53 and the doubles are gathered, and tested
+    // by the SIMD kernel. flagged (index) is called, in order, with the items
+    // that fail and with those it cannot decide; the check stops when it
+    // returns false.
+        template <typename Flagged>
+        bool
+    check_numeric_items (json_t::array_t const& items, numeric_items_t const& numeric, Flagged&& flagged)
+    {
+            constexpr auto
+        exact = std::uint64_t { 1 } << 53;
+            std::array <double, 64>
+        values;
+        for (std::size_t base = 0; base < items.size (); base += values.size ())
+        {
+                auto
+            count = std::min (values.size (), items.size () - base);
+                std::uint64_t
+            undecided = 0;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                    auto const&
+                item = items[base + i];
+                values[i] = 0;
+                switch (item.type ())
+                {
+                    case tao::json::type::SIGNED:
+                    {
+                            auto
+                        v = item.get_signed ();
+                        if (v < -static_cast <std::int64_t> (exact) || v > static_cast <std::int64_t> (exact))
+                        {
+                            undecided |= std::uint64_t { 1 } << i;
+                            break;
+                        }
+                        values[i] = static_cast <double> (v);
+                        break;
+                    }
+                    case tao::json::type::UNSIGNED:
+                    {
+                            auto
+                        v = item.get_unsigned ();
+                        if (v > exact)
+                        {
+                            undecided |= std::uint64_t { 1 } << i;
+                            break;
+                        }
+                        values[i] = static_cast <double> (v);
+                        break;
+                    }
+                    case tao::json::type::DOUBLE:
+                        if (numeric.integer_only)
+                        {
+                            undecided |= std::uint64_t { 1 } << i;
+                            break;
+                        }
+                        values[i] = item.get_double ();
+                        break;
+                    default:
+                        undecided |= std::uint64_t { 1 } << i;
+                }
+            }
+                auto
+            failed = undecided | simd::out_of_range (values.data (), count, numeric.range);
+            if (numeric.multiple_of != 0)
+            {
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    if (
+                           !(failed & (std::uint64_t { 1 } << i))
+                        && remainder (values[i], numeric.multiple_of) != 0
+                    ){
+                        failed |= std::uint64_t { 1 } << i;
+                    }
+                }
+            }
+            for (; failed; failed &= failed - 1)
+            {
+                if (!flagged (base + static_cast <std::size_t> (std::countr_zero (failed))))
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // Follows the references of a node.
+        inline compiled_schema_ptr
+    resolve_references (compiled_schema_ptr node)
+    {
+        // Bounded, for reference cycles.
+        for (int i = 0; i < 64 && node && !node->is_boolean && node->has (kw_ref); ++i)
+        {
+            node = node->ref;
+        }
+        if (node && !node->is_boolean && node->has (kw_ref))
+        {
+            return nullptr;
+        }
+        return node;
+    }
+
+    // The strings a branch pins a required property to, if it does.
+        inline auto
+    discriminating_values (compiled_schema_ptr branch, std::string const& property)
+        -> std::optional <std::vector <std::string_view>>
+    {
+        branch = resolve_references (branch);
+        if (
+               !branch
+            || branch->is_boolean
+            || !branch->has (kw_required)
+            || std::none_of (
+                  std::begin (branch->required)
+                , std::end (branch->required)
+                , [&](auto&& r) { return *r == property; }
+               )
+        ){
+            return {};
+        }
+            auto
+        i = branch->properties.find (property);
+        if (i == branch->properties.end ())
+        {
+            return {};
+        }
+            auto
+        s = resolve_references (i->second);
+        if (!s || s->is_boolean)
+        {
+            return {};
+        }
+        if (s->has (kw_const))
+        {
+            if (!s->const_value->is_string ())
+            {
+                return {};
+            }
+            return std::vector <std::string_view> { s->const_value->get_string () };
+        }
+        if (s->has (kw_enum))
+        {
+                std::vector <std::string_view>
+            values;
+            for (auto&& v: *s->enum_values)
+            {
+                if (!v.is_string ())
+                {
+                    return {};
+                }
+                values.push_back (v.get_string ());
+            }
+            return values;
+        }
+        return {};
+    }
+
+    // Looks for a property that discriminates all the branches.
+        inline auto
+    find_discriminator (std::vector <compiled_schema_ptr> const& branches)
+        -> std::optional <discriminator_t>
+    {
+        if (branches.size () < 2)
+        {
+            return {};
+        }
+            auto
+        first = resolve_references (branches.front ());
+        if (!first || first->is_boolean)
+        {
+            return {};
+        }
+        for (auto&& property: first->required)
+        {
+                discriminator_t
+            d { property, {} };
+                std::size_t
+            index = 0;
+            for (; index < branches.size (); ++index)
+            {
+                    auto
+                values = discriminating_values (branches[index], *property);
+                if (!values)
+                {
+                    break;
+                }
+                for (auto&& v: *values)
+                {
+                        auto&
+                    b = d.branches[v];
+                    if (b.empty () || b.back () != index)
+                    {
+                        b.push_back (index);
+                    }
+                }
+            }
+            if (index == branches.size ())
+            {
+                return d;
+            }
+        }
+        return {};
+    }
+
+    // The branches an instance may satisfy, or nullptr when any of them may.
+        inline auto
+    candidate_branches (const discriminator_t* d, const json_t& instance)
+        -> const std::vector <std::size_t>*
+    {
+            static const std::vector <std::size_t>
+        none;
+        if (!d || !instance.is_object ())
+        {
+            return nullptr;
+        }
+            auto const&
+        object = instance.get_object ();
+            auto
+        i = object.find (*d->property);
+        if (i == object.end () || !i->second.is_string_type ())
+        {
+            return &none;
+        }
+            auto
+        j = d->branches.find (i->second.get_string_type ());
+        if (j == d->branches.end ())
+        {
+            return &none;
+        }
+        return &j->second;
+    }
+
+    // Calls f (index) on the branches an instance may satisfy, until it
+    // returns true. Returns whether it did.
+        template <typename F>
+        bool
+    any_candidate (
+          const discriminator_t* d
+        , const json_t&          instance
+        , std::size_t            count
+        , F&&                    f
+    ){
+        if (
+                auto
+              candidates = candidate_branches (d, instance)
+            ; candidates
+        ){
+            return std::any_of (std::begin (*candidates), std::end (*candidates), f);
+        }
+        for (std::size_t index = 0; index < count; ++index)
+        {
+            if (f (index))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // One step of a JSON Pointer: a literal prefix, optionally followed by a
+    // property name or an index. Nothing is copied until it is rendered.
+        struct
+    location_segment_t
+    {
+            static constexpr std::size_t
+        no_index = static_cast <std::size_t> (-1);
+            std::string_view
+        prefix;
+            const std::string*
+        name = nullptr;
+            std::size_t
+        index = no_index;
+    };
+
+        inline void
+    append_segment (std::string& out, location_segment_t const& segment)
+    {
+        out += segment.prefix;
+        if (segment.name)
+        {
+            for (auto c: *segment.name)
+            {
+                switch (c)
+                {
+                    case '~': out += "~0"; break;
+                    case '/': out += "~1"; break;
+                    default:  out += c;
+                }
+            }
+        }
+        if (segment.index != location_segment_t::no_index)
+        {
+                char
+            buffer[24];
+                auto
+            [end, ec] = std::to_chars (std::begin (buffer), std::end (buffer), segment.index);
+            out.append (buffer, end);
+        }
+    }
+
+        inline std::string
+    render_location (
+          std::string_view                       root
+        , std::vector <location_segment_t> const& path
+    ){
+            std::string
+        out { root };
+        for (auto&& segment: path)
+        {
+            append_segment (out, segment);
+        }
+        return out;
+    }
+
+#ifdef CALCULISTO_JSON_VALIDATOR_PROFILE
+        struct
+    profile_stats_t
+    {
+            std::size_t
+        calls = 0;
+            std::size_t
+        failures = 0;
+            std::chrono::nanoseconds
+        time {};
+    };
+
+    // What validate_impl () spent, per keyword and per schema location. Only
+    // compiled when CALCULISTO_JSON_VALIDATOR_PROFILE is defined. The time of
+    // a keyword or a location includes the time of the sub-schemas it
+    // applies; the self time of a location excludes it.
+        struct
+    profile_t
+    {
+            struct
+        location_t
+        {
+                profile_stats_t
+            stats;
+                std::chrono::nanoseconds
+            self_time {};
+            // The pairs its keywords evaluated without diagnostics, with
+            // is_valid_impl (). Their time is part of its own.
+                std::size_t
+            evaluations = 0;
+            // The locations of the enclosing frames, joined by ';'.
+                std::string
+            stack;
+        };
+
+            std::array <profile_stats_t, kw_count>
+        keywords {};
+            std::unordered_map <std::string, location_t>
+        locations;
+            std::size_t
+        validations = 0;
+            std::size_t
+        nodes_visited = 0;
+
+        // Scratch state of the frames being evaluated: their location, the
+        // keyword being evaluated and the time spent in their sub-frames.
+            struct
+        open_frame_t
+        {
+                location_t*
+            location;
+                profile_stats_t*
+            keyword;
+                std::chrono::nanoseconds
+            children;
+        };
+            std::vector <open_frame_t>
+        open_frames;
+
+        // Charges an evaluation without diagnostics to the current frame.
+            void
+        evaluation () noexcept
+        {
+            if (!open_frames.empty ())
+            {
+                ++open_frames.back ().location->evaluations;
+            }
+        }
+
+        // Charges a failure to the current frame and keyword.
+            void
+        failure () noexcept
+        {
+            if (open_frames.empty ())
+            {
+                return;
+            }
+            ++open_frames.back ().location->stats.failures;
+            if (open_frames.back ().keyword)
+            {
+                ++open_frames.back ().keyword->failures;
+            }
+        }
+
+            void
+        merge (profile_t const& other)
+        {
+            for (std::size_t i = 0; i < kw_count; ++i)
+            {
+                keywords[i].calls += other.keywords[i].calls;
+                keywords[i].failures += other.keywords[i].failures;
+                keywords[i].time += other.keywords[i].time;
+            }
+            for (auto&& [key, location]: other.locations)
+            {
+                    auto&
+                l = locations[key];
+                l.stats.calls += location.stats.calls;
+                l.stats.failures += location.stats.failures;
+                l.stats.time += location.stats.time;
+                l.self_time += location.self_time;
+                l.evaluations += location.evaluations;
+                l.stack = location.stack;
+            }
+            validations += other.validations;
+            nodes_visited += other.nodes_visited;
+        }
+
+            void
+        clear ()
+        {
+            keywords = {};
+            locations.clear ();
+            validations = 0;
+            nodes_visited = 0;
+        }
+
+        // A human readable report, the most expensive first.
+            std::string
+        table () const
+        {
+                auto
+            ms = [](std::chrono::nanoseconds t) { return t.count () / 1e6; };
+                std::string
+            out = fmt::format (
+                  "validations: {}, nodes visited: {} ({:.1f} per validation)\n\n"
+                , validations
+                , nodes_visited
+                , validations ? static_cast <double> (nodes_visited) / validations : 0.
+            );
+                std::vector <std::size_t>
+            order;
+            for (std::size_t i = 0; i < kw_count; ++i)
+            {
+                if (keywords[i].calls)
+                {
+                    order.push_back (i);
+                }
+            }
+            std::sort (std::begin (order), std::end (order), [&](auto a, auto b)
+            {
+                return keywords[a].time > keywords[b].time;
+            });
+            out += fmt::format ("{:>12} {:>12} {:>12}  {}\n", "calls", "failures", "time (ms)", "keyword");
+            for (auto&& i: order)
+            {
+                out += fmt::format (
+                      "{:>12} {:>12} {:>12.3f}  {}\n"
+                    , keywords[i].calls
+                    , keywords[i].failures
+                    , ms (keywords[i].time)
+                    , keyword_names[i]
+                );
+            }
+                std::vector <std::pair <std::string const*, location_t const*>>
+            sorted;
+            for (auto&& [key, location]: locations)
+            {
+                sorted.emplace_back (&key, &location);
+            }
+            std::sort (std::begin (sorted), std::end (sorted), [](auto&& a, auto&& b)
+            {
+                return a.second->stats.time > b.second->stats.time;
+            });
+            out += fmt::format ("\n{:>12} {:>12} {:>12} {:>12} {:>12}  {}\n", "calls", "failures", "evaluations", "time (ms)", "self (ms)", "schema location");
+            for (auto&& [key, location]: sorted)
+            {
+                out += fmt::format (
+                      "{:>12} {:>12} {:>12} {:>12.3f} {:>12.3f}  {}\n"
+                    , location->stats.calls
+                    , location->stats.failures
+                    , location->evaluations
+                    , ms (location->stats.time)
+                    , ms (location->self_time)
+                    , *key
+                );
+            }
+            return out;
+        }
+
+        // One "frame;frame;frame nanoseconds" line per location, with its
+        // self time, as read by flamegraph.pl and compatible tools.
+            std::string
+        folded_stacks () const
+        {
+                std::string
+            out;
+            for (auto&& [key, location]: locations)
+            {
+                out += fmt::format ("{} {}\n", location.stack, location.self_time.count ());
+            }
+            return out;
+        }
+    };
+#endif
+
+        using
+    error_id_t = std::size_t;
+
+        inline constexpr error_id_t
+    no_error = static_cast <error_id_t> (-1);
+
+    // A recorded error, with its locations already rendered. Its sub-errors
+    // are other entries of the same context.
+        struct
+    error_entry_t
+    {
+            enum
+        kind_t
+            : std::uint8_t
+        {
+              boolean_schema // "boolean schema is false"
+            , leaf           // no sub-errors
+            , single         // "errors" is the only sub-error
+            , array          // "errors" is the array of sub-errors
+        };
+            kind_t
+        kind = leaf;
+            std::string
+        schema_location;
+            std::string
+        instance_location;
+            std::string
+        message;
+            std::vector <error_id_t>
+        children;
+    };
+
+    // The outcomes of (sub-schema, instance node) pairs, by the address of
+    // the instance node, kept across validations of the same instance: what
+    // an incremental revalidation reuses. The outcome of a pair only depends
+    // on the sub-tree of its instance node, so that it holds until that
+    // sub-tree changes.
+        struct
+    trace_t
+    {
+            std::unordered_map <
+                  const json_t*
+                , std::vector <std::pair <const compiled_schema_t*, bool>>
+            >
+        outcomes;
+
+            auto
+        find (const compiled_schema_t& schema, const json_t& instance) const
+            -> std::optional <bool>
+        {
+            if (
+                    auto&&
+                  i = outcomes.find (&instance)
+                ; i != outcomes.end ()
+            ){
+                for (auto&& [s, valid]: i->second)
+                {
+                    if (s == &schema)
+                    {
+                        return valid;
+                    }
+                }
+            }
+            return std::nullopt;
+        }
+
+            void
+        record (const compiled_schema_t& schema, const json_t& instance, bool valid)
+        {
+                auto&
+            pairs = outcomes[&instance];
+            for (auto&& [s, v]: pairs)
+            {
+                if (s == &schema)
+                {
+                    v = valid;
+                    return;
+                }
+            }
+            pairs.emplace_back (&schema, valid);
+        }
+
+        // Forgets the pairs of a node, which changed.
+            void
+        forget (const json_t& instance)
+        {
+            outcomes.erase (&instance);
+        }
+
+        // Forgets the pairs of a whole sub-tree, which is about to go away.
+            void
+        forget_tree (const json_t& instance)
+        {
+            forget (instance);
+            if (instance.is_object ())
+            {
+                for (auto&& [key, value]: instance.get_object ())
+                {
+                    forget_tree (value);
+                }
+            }
+            else if (instance.is_array ())
+            {
+                for (auto&& value: instance.get_array ())
+                {
+                    forget_tree (value);
+                }
+            }
+        }
+    };
+
+        struct
+    memo_hash_t
+    {
+            std::size_t
+        operator () (std::pair <const compiled_schema_t*, const json_t*> const& key) const noexcept
+        {
+            return mix_hash (
+                  reinterpret_cast <std::uintptr_t> (key.first)
+                ^ (reinterpret_cast <std::uintptr_t> (key.second) << 1)
+            );
+        }
+    };
+
+    // Scratch state for one validation: the current locations and the errors
+    // recorded so far.
+        struct
+    context_t
+    {
+            std::vector <location_segment_t>
+        instance_path;
+            std::vector <location_segment_t>
+        schema_path;
+            std::vector <error_entry_t>
+        entries;
+        // The (instance, sub-schema) pairs evaluated, with diagnostics or
+        // by is_valid_impl ().
+            std::size_t
+        visited = 0;
+        // When memoize is set, the outcome of each pair evaluated, by the
+        // addresses of the sub-schema and of the instance node. The pairs met
+        // while unmemoized is not zero, whose instance is a temporary, are
+        // not remembered.
+            bool
+        memoize = false;
+            std::size_t
+        unmemoized = 0;
+            std::unordered_map <
+                  std::pair <const compiled_schema_t*, const json_t*>
+                , std::pair <bool, error_id_t>
+                , memo_hash_t
+            >
+        memo;
+        // The same, for the pairs evaluated without diagnostics, by
+        // is_valid_impl () ("anyOf", "oneOf", "not", "if", "contains"...).
+            std::unordered_map <
+                  std::pair <const compiled_schema_t*, const json_t*>
+                , bool
+                , memo_hash_t
+            >
+        outcomes;
+        // The outcomes kept across validations, reused and completed. Only
+        // the pairs that are not under unmemoized are traced.
+            trace_t*
+        trace = nullptr;
+        // The limits of validation_options_t (0 for none), and the failures
+        // whose errors they dropped.
+            std::size_t
+        max_errors = 0;
+            std::size_t
+        max_branch_errors = 0;
+            std::size_t
+        suppressed = 0;
+
+        // Whether a failure, with kept sibling failures, is to be counted
+        // rather than recorded.
+            bool
+        over_budget (std::size_t kept) const noexcept
+        {
+            return (max_errors && entries.size () >= max_errors)
+                || (max_branch_errors && kept >= max_branch_errors);
+        }
+#ifdef CALCULISTO_JSON_VALIDATOR_PROFILE
+        // Kept across validations.
+            profile_t
+        profile;
+#endif
+
+        // Counts a pair evaluated by is_valid_impl (). Its time is part of
+        // the frame and keyword that called it: the profile charges it to
+        // their schema location, as an evaluation.
+            void
+        count_evaluation () noexcept
+        {
+            ++visited;
+#ifdef CALCULISTO_JSON_VALIDATOR_PROFILE
+            profile.evaluation ();
+#endif
+        }
+
+            error_id_t
+        record (
+              error_entry_t::kind_t     kind
+            , location_segment_t const& sub_schema_location = {}
+            , std::string               message = {}
+            , std::vector <error_id_t>  children = {}
+        ){
+#ifdef CALCULISTO_JSON_VALIDATOR_PROFILE
+            profile.failure ();
+#endif
+                auto&
+            entry = entries.emplace_back ();
+            entry.kind = kind;
+            if (kind != error_entry_t::boolean_schema)
+            {
+                entry.schema_location = render_location ("#", schema_path);
+                append_segment (entry.schema_location, sub_schema_location);
+                entry.instance_location = render_location ("/", instance_path);
+                entry.message = std::move (message);
+                // The failures past a budget have no entry: an entry they
+                // leave without sub-errors is a leaf.
+                if (std::erase (children, no_error) > 0 && children.empty ())
+                {
+                    entry.kind = error_entry_t::leaf;
+                }
+                entry.children = std::move (children);
+            }
+            return entries.size () - 1;
+        }
+    };
+
+#ifdef CALCULISTO_JSON_VALIDATOR_PROFILE
+    // Times a validate_impl () frame, and charges it to its schema location.
+        class
+    frame_probe_t
+    {
+            context_t&
+        context_m;
+            std::chrono::steady_clock::time_point
+        start_m;
+
+    public:
+            explicit
+        frame_probe_t (context_t& context)
+            : context_m { context }
+        {
+                auto&
+            location = context.profile.locations[render_location ("#", context.schema_path)];
+            if (location.stack.empty ())
+            {
+                // ';' separates the frames.
+                location.stack = "#";
+                for (auto&& segment: context.schema_path)
+                {
+                        std::string
+                    frame;
+                    append_segment (frame, segment);
+                    std::replace (std::begin (frame), std::end (frame), ';', ',');
+                    location.stack += ';' + frame;
+                }
+            }
+            ++location.stats.calls;
+            context.profile.open_frames.push_back ({ &location, nullptr, {} });
+            start_m = std::chrono::steady_clock::now ();
+        }
+
+        ~frame_probe_t ()
+        {
+                auto
+            time = std::chrono::steady_clock::now () - start_m;
+                auto&
+            frames = context_m.profile.open_frames;
+                auto
+            frame = frames.back ();
+            frames.pop_back ();
+            frame.location->stats.time += time;
+            frame.location->self_time += time - frame.children;
+            if (!frames.empty ())
+            {
+                frames.back ().children += time;
+            }
+        }
+
+        frame_probe_t (frame_probe_t const&) = delete;
+            frame_probe_t&
+        operator = (frame_probe_t const&) = delete;
+    };
+
+    // Times a keyword, in the current frame.
+        class
+    keyword_probe_t
+    {
+            context_t&
+        context_m;
+            std::chrono::steady_clock::time_point
+        start_m;
+            profile_stats_t&
+        stats_m;
+
+    public:
+        keyword_probe_t (context_t& context, keyword_t keyword)
+            : context_m { context }
+            , start_m   { std::chrono::steady_clock::now () }
+            , stats_m   { context.profile.keywords[keyword] }
+        {
+            ++stats_m.calls;
+            context.profile.open_frames.back ().keyword = &stats_m;
+        }
+
+        ~keyword_probe_t ()
+        {
+            stats_m.time += std::chrono::steady_clock::now () - start_m;
+            context_m.profile.open_frames.back ().keyword = nullptr;
+        }
+
+        keyword_probe_t (keyword_probe_t const&) = delete;
+            keyword_probe_t&
+        operator = (keyword_probe_t const&) = delete;
+    };
+#else
+        struct
+    frame_probe_t
+    {
+            explicit
+        frame_probe_t (context_t&) noexcept
+        {}
+    };
+
+        struct
+    keyword_probe_t
+    {
+        keyword_probe_t (context_t&, keyword_t) noexcept
+        {}
+    };
+#endif
+
+        inline json_t
+    render_error (std::vector <error_entry_t> const& entries, error_id_t id)
+    {
+            auto const&
+        entry = entries[id];
+        if (entry.kind == error_entry_t::boolean_schema)
+        {
+            return "boolean schema is false";
+        }
+            json_t
+        v = {
+              { "schemaLocation", entry.schema_location }
+            , { "instanceLocation", entry.instance_location }
+            , { "message" , entry.message }
+        };
+        if (entry.kind == error_entry_t::single)
+        {
+            v["errors"] = render_error (entries, entry.children.front ());
+        }
+        if (entry.kind == error_entry_t::array)
+        {
+                json_t::array_t
+            a;
+            a.reserve (entry.children.size ());
+            for (auto&& child: entry.children)
+            {
+                a.push_back (render_error (entries, child));
+            }
+            v["errors"] = std::move (a);
+        }
+        return v;
+    }
+} // }}} namespace detail
+
+// The outcome of a validation. The errors are kept in a compact form and
+// only turned into JSON when asked for.
+    class
+validation_result_t
+{
+        bool
+    valid_m = true;
+        std::vector <detail::error_entry_t>
+    entries_m;
+        detail::error_id_t
+    root_m = detail::no_error;
+        std::size_t
+    nodes_visited_m = 0;
+        std::size_t
+    suppressed_m = 0;
+
+public:
+    validation_result_t () = default;
+
+    validation_result_t (
+          bool                                 valid
+        , std::vector <detail::error_entry_t>&& entries
+        , detail::error_id_t                   root
+        , std::size_t                          nodes_visited = 0
+        , std::size_t                          suppressed = 0
+    )
+        : valid_m         { valid }
+        , entries_m       { std::move (entries) }
+        , root_m          { root }
+        , nodes_visited_m { nodes_visited }
+        , suppressed_m    { suppressed }
+    {}
+
+        bool
+    valid () const noexcept
+    {
+        return valid_m;
+    }
+
+        explicit
+    operator bool () const noexcept
+    {
+        return valid_m;
+    }
+
+        auto
+    entries () const noexcept
+        -> std::vector <detail::error_entry_t> const&
+    {
+        return entries_m;
+    }
+
+    // The number of (instance node, sub-schema) pairs the validation
+    // evaluated, with diagnostics or not, memoized and traced outcomes
+    // aside: a measure of its cost.
+        std::size_t
+    nodes_visited () const noexcept
+    {
+        return nodes_visited_m;
+    }
+
+    // Whether validation_options_t limits dropped errors.
+        bool
+    truncated () const noexcept
+    {
+        return suppressed_m > 0;
+    }
+
+    // The number of failing (instance node, sub-schema) pairs whose errors
+    // were dropped.
+        std::size_t
+    suppressed_errors () const noexcept
+    {
+        return suppressed_m;
+    }
+
+    // The errors, as returned by validator_t::validate (). When truncated,
+    // the top-level error tells it, with "truncated" and "suppressedErrors".
+        json_t
+    errors () const
+    {
+        if (root_m == detail::no_error)
+        {
+            return tao::json::null;
+        }
+            auto
+        e = detail::render_error (entries_m, root_m);
+        if (truncated () && e.is_object ())
+        {
+            e["truncated"] = true;
+            e["suppressedErrors"] = suppressed_m;
+        }
+        return e;
+    }
+};
+
+// Limits on the errors a validation builds. Past them, the failures are only
+// counted: the validity is still exact.
+    struct
+validation_options_t
+{
+    // The number of errors recorded, at most, but for those of the keywords
+    // being evaluated when it is reached. 0 means no limit.
+        std::size_t
+    max_errors = 0;
+    // The number of failing sub-schemas or items an applicator keeps the
+    // errors of. 0 means no limit.
+        std::size_t
+    max_branch_errors = 0;
+};
+
+    struct
+batch_options_t
+{
+    // 0 means one thread per hardware thread.
+        std::size_t
+    threads = 0;
+    // The number of instances a task validates. 0 means a size chosen from
+    // the size of the batch and the number of threads.
+        std::size_t
+    chunk_size = 0;
+    // When false, only the validity of each instance is computed.
+        bool
+    collect_errors = true;
+};
+
+    struct
+batch_result_t
+{
+    // valid[i] tells whether the i-th instance is valid.
+        std::vector <std::uint8_t>
+    valid;
+    // The index and errors of each invalid instance, in input order. Empty
+    // when batch_options_t::collect_errors is false.
+        std::vector <std::pair <std::size_t, json_t>>
+    errors;
+};
+
+    class
+stream_validator_t;
+    class
+ndjson_validator_t;
+    class
+schema_cache_t;
+    class
+code_generator_t;
+    class
+incremental_validator_t;
+
+// Scratch memory for validations. Reusing one context for the successive
+// validations of a thread spares their allocations. A context must not be
+// used by two threads at the same time. When CALCULISTO_JSON_VALIDATOR_PROFILE
+// is defined, the context also profiles the validations made with it.
+    class
+validation_context_t
+{
+    friend class validator_t;
+        detail::context_t
+    context_m;
+
+public:
+    // When on, the validations made with this context remember the outcome
+    // of each (sub-schema, instance node) pair they evaluate, and reuse it
+    // when a "$ref" or an applicator leads to the same pair again: their cost
+    // is bounded by the size of the schema times the size of the instance.
+    // A reused failure keeps the locations of its first evaluation. Off by
+    // default.
+        void
+    memoize (bool on) noexcept
+    {
+        context_m.memoize = on;
+    }
+
+    // The error limits of the validations made with this context.
+        void
+    options (validation_options_t const& options) noexcept
+    {
+        context_m.max_errors = options.max_errors;
+        context_m.max_branch_errors = options.max_branch_errors;
+    }
+
+#ifdef CALCULISTO_JSON_VALIDATOR_PROFILE
+    // What the validations made with this context cost so far.
+        auto
+    profile () noexcept
+        -> detail::profile_t&
+    {
+        return context_m.profile;
+    }
+#endif
+};
+
+// Schemas are registered with add_schema (). Once registration is over, the
+// validator is immutable: its const member functions can be called from any
+// number of threads at the same time, their scratch state lives in a
+// validation_context_t or on the stack.
+    class
+validator_t
+{
+    friend class stream_validator_t;
+    friend class ndjson_validator_t;
+    friend class schema_cache_t;
+    friend class code_generator_t;
+    friend class incremental_validator_t;
+private: 
+    // The draft-07 meta-schema is registered once per process, in a
+    // validator that every other one refers to. It is only read.
+        const validator_t*
+    meta_m = nullptr;
+    // The schema documents, at stable addresses, and by content hash.
+        std::deque <schema_t>
+    schemas_m;
+        std::unordered_multimap <std::uint64_t, const schema_t*>
+    schema_hashes_m;
+        const schema_t*
+    last_schema_m = nullptr;
+        const schema_t*
+    meta_schema_m = nullptr;
+        std::unordered_map <std::string, const schema_t*>
+    registered_schemas_m;
+        std::unordered_map <const json_t*, const schema_t*>
+    registered_references_m;
+        std::unordered_set <const schema_t*>
+    analysed_schemas_m;
+        std::vector <const schema_t*>
+    pending_compilation_m;
+        std::deque <detail::compiled_schema_t>
+    compiled_schemas_m;
+        std::unordered_map <const schema_t*, detail::compiled_schema_ptr>
+    compiled_index_m;
+        std::unordered_map <std::string, std::regex>
+    regexes_m;
+        std::deque <detail::value_set_t>
+    value_sets_m;
+        std::deque <detail::discriminator_t>
+    discriminators_m;
+    // Closed sub-schemas, by content hash. An equal one met later is an
+    // alias: it is neither analysed nor compiled, and shares the nodes of the
+    // first one.
+        std::unordered_multimap <std::uint64_t, const schema_t*>
+    shared_schemas_m;
+    // During a registration: the objects of the new document, and the
+    // aliases found.
+        detail::subtree_index_t
+    subtrees_m;
+        std::unordered_map <const schema_t*, const schema_t*>
+    aliases_m;
+    // Whether "format" is an assertion, rather than an annotation.
+        bool
+    assert_formats_m = false;
+
+        struct
+    meta_schema_tag_t
+    {};
+
+    // The validator that holds the meta-schema.
+        explicit
+    validator_t (meta_schema_tag_t)
+    {
+        meta_schema_m = add_schema_impl (
+              tao::json::from_string (detail::draft_07_schema)
+            , "http://json-schema.org/draft-07/schema"
+        );
+        last_schema_m = meta_schema_m;
+    }
+
+    // Built on first use, thread-safely.
+        static auto
+    meta_validator ()
+        -> validator_t const&
+    {
+            static const validator_t
+        meta { meta_schema_tag_t {} };
+        return meta;
+    }
+
+    // The lookups below fall back on the meta-schema validator.
+        auto
+    find_compiled (schema_t const& schema) const
+        -> detail::compiled_schema_ptr
+    {
+        if (
+                auto&&
+              i = compiled_index_m.find (&schema)
+            ; i != compiled_index_m.end ()
+        ){
+            return i->second;
+        }
+        return meta_m ? meta_m->find_compiled (schema) : nullptr;
+    }
+
+        auto
+    find_registered (std::string const& uri) const
+        -> const schema_t*
+    {
+        if (
+                auto&&
+              i = registered_schemas_m.find (uri)
+            ; i != registered_schemas_m.end ()
+        ){
+            return i->second;
+        }
+        return meta_m ? meta_m->find_registered (uri) : nullptr;
+    }
+
+        bool
+    is_analysed (schema_t const& schema) const
+    {
+        return analysed_schemas_m.count (&schema) > 0
+            || (meta_m && meta_m->is_analysed (schema));
+    }
+
+    // An equal closed sub-schema, met before.
+        auto
+    find_shared (schema_t const& schema, std::uint64_t hash) const
+        -> const schema_t*
+    {
+            auto
+        [first, last] = shared_schemas_m.equal_range (hash);
+        for (; first != last; ++first)
+        {
+            if (first->second != &schema && *first->second == schema)
+            {
+                return first->second;
+            }
+        }
+        return meta_m ? meta_m->find_shared (schema, hash) : nullptr;
+    }
+
+    // A document equal to one already registered is not registered again.
+        auto
+    find_document (json_t const& json, std::uint64_t hash) const
+        -> const schema_t*
+    {
+            auto
+        [first, last] = schema_hashes_m.equal_range (hash);
+        for (; first != last; ++first)
+        {
+            if (*first->second == json)
+            {
+                return first->second;
+            }
+        }
+        return meta_m ? meta_m->find_document (json, hash) : nullptr;
+    }
+
+        auto
+    add_schema_impl (json_t const& json, uri_t const& document_uri)
+        -> const schema_t*
+    {
+            auto
+        hash = detail::hash_value (json);
+        if (auto schema = find_document (json, hash))
+        {
+            return schema;
+        }
+        return register_document (schemas_m.emplace_back (json), hash, document_uri);
+    }
+
+        auto
+    add_schema_impl (json_t&& json, uri_t const& document_uri)
+        -> const schema_t*
+    {
+            auto
+        hash = detail::hash_value (json);
+        if (auto schema = find_document (json, hash))
+        {
+            return schema;
+        }
+        return register_document (schemas_m.emplace_back (std::move (json)), hash, document_uri);
+    }
+
+        auto
+    register_document (schema_t const& schema, std::uint64_t hash, uri_t const& document_uri)
+        -> const schema_t*
+    {
+        schema_hashes_m.emplace (hash, &schema);
+        register_schema (schema, document_uri);
+        detail::index_subtrees (schema, subtrees_m);
+        analyse (schema, document_uri);
+        compile_pending ();
+        subtrees_m.clear ();
+        return &schema;
+    }
+
+    // Whether the sub-schema is an alias of an equal closed one.
+        bool
+    share_subschema (schema_t const& schema)
+    {
+            auto
+        i = subtrees_m.find (&schema);
+        if (i == subtrees_m.end () || !i->second.closed)
+        {
+            return false;
+        }
+            auto
+        hash = i->second.hash;
+        if (
+                auto
+              shared = find_shared (schema, hash)
+            ; shared
+        ){
+            aliases_m.emplace (&schema, shared);
+            return true;
+        }
+        shared_schemas_m.emplace (hash, &schema);
+        return false;
+    }
+
+    // Gives the sub-schemas of an alias the compiled nodes of their
+    // counterparts, for the references and URIs that point into it.
+        void
+    share_compiled (json_t const& alias, json_t const& shared)
+    {
+        if (
+                auto
+              node = find_compiled (shared)
+            ; node
+        ){
+            compiled_index_m.emplace (&alias, node);
+        }
+        if (alias.is_array ())
+        {
+            for (std::size_t i = 0; i < alias.get_array ().size (); ++i)
+            {
+                share_compiled (alias.get_array ()[i], shared.get_array ()[i]);
+            }
+        }
+        if (alias.is_object ())
+        {
+            // Equal objects have the same keys, in the same order.
+                auto
+            j = std::begin (shared.get_object ());
+            for (auto&& [key, value]: alias.get_object ())
+            {
+                share_compiled (value, (j++)->second);
+            }
+        }
+    }
+
+        auto
+    register_schema (schema_t const& schema, uri_t const& uri)
+        -> void
+    {
+        registered_schemas_m[uri.string ()] = &schema;
+    }
+
+        auto
+    register_regex (std::string const& pattern)
+        -> const std::regex*
+    {
+        if (
+                auto&&
+              i = regexes_m.find (pattern)
+            ; i != regexes_m.end ()
+        ){
+            return &i->second;
+        }
+        try
+        {
+            return &regexes_m.emplace (pattern, std::regex { pattern }).first->second;
+        }
+        catch (std::regex_error const& e)
+        {
+            throw (std::runtime_error { fmt::format (
+                  "{}:{}: Invalid regular expression \"{}\": {}."
+                , __FILE__
+                , __LINE__
+                , pattern
+                , e.what ()
+            )});
+        }
+    }
+
+        auto
+    register_reference (json_t const& reference, schema_t const& schema)
+        -> void
+    {
+        registered_references_m[&reference] = &schema;
+    }
+
+        auto
+    resolve_reference (uri_t const& target) const
+        -> std::pair <const schema_t*, uri_t>
+    {
+            auto
+        absolute = target.absolute ();
+        if ( 
+                auto
+              root_schema = find_registered (absolute)
+            ; root_schema
+        ){
+            try
+            {
+                    tao::json::pointer
+                pointer { uri::decode_percent (target.fragment ()) };
+                return { &(root_schema->at (pointer)), absolute };
+            }
+            catch (std::exception const& e)
+            {
+                throw (std::runtime_error { fmt::format (
+                      "{}:{}: Resolution of pointer {} in schema {} failed: {}."
+                    , __FILE__
+                    , __LINE__
+                    , target.fragment ()
+                    , absolute.string ()
+                    , e.what ()
+                )});
+            }      
+        }
+        throw (std::runtime_error { fmt::format (
+              "Couldn't resolve reference {}."
+            , target.string ()
+        )});
+    }
+
+        auto
+    resolve_reference (std::string const& ref, uri_t const& base_uri) const
+        -> std::pair <const schema_t*, uri_t>
+    {
+            auto
+        target = base_uri.resolve (ref);
+        if (
+                auto
+              schema = find_registered (target)
+            ; schema
+        ){
+            return { schema, base_uri };
+        }
+        return resolve_reference (target);
+    }
+
+        void
+    analyse (schema_t const& schema, uri_t const& current_base_uri)
+    {
+        if (share_subschema (schema))
+        {
+            return;
+        }
+        pending_compilation_m.push_back (&schema);
+        if (schema.is_boolean ()) return; 
+        if (!schema.is_object ())
+        {
+            throw (std::runtime_error { fmt::format (
+                  "{}:{}: Schema \"{}\" is not an object."
+                , __FILE__
+                , __LINE__
+                , to_string (schema)
+            )});
+        }
+        analysed_schemas_m.insert (&schema);
+            auto const&
+        schema_object = schema.get_object ();
+            auto
+        base_uri = current_base_uri;
+            json_t::object_t::const_iterator
+        it;
+        if (
+              it = schema_object.find ("$id")
+            ; it != schema_object.end ()
+        ){
+                auto&
+            id = it->second.get_string ();
+            base_uri = base_uri.resolve (id);
+            register_schema (schema, base_uri);
+        }
+        if (
+              it = schema_object.find ("$ref")
+            ; it != schema_object.end ()
+                && registered_references_m.count (&(it->second)) == 0
+        ){
+                auto&
+            ref = it->second;
+                auto&
+            ref_string = ref.get_string ();
+                auto
+            [ schema, uri ] = resolve_reference (ref_string, base_uri);
+            register_reference (ref, *schema);
+            // Some references might point to places whe do not analyse.
+            if (!is_analysed (*schema)) 
+            {
+                analyse (*schema, uri);
+            }
+        }
+        for (auto&& [name, value]: schema_object)
+        {
+                auto
+            keyword = detail::find_keyword (name);
+            switch (keyword.kind)
+            {
+                case detail::holds_schema:
+                    analyse (value, base_uri);
+                    break;
+                case detail::holds_object_of_schemas:
+                    for (auto&& [key, subschema]: value.get_object ())
+                    {
+                        if (keyword.keyword == detail::kw_pattern_properties)
+                        {
+                            register_regex (key);
+                        }
+                        analyse (subschema, base_uri);
+                    }
+                    break;
+                case detail::holds_array_of_schemas:
+                    for (auto&& subschema: value.get_array ())
+                    {
+                        analyse (subschema, base_uri);
+                    }
+                    break;
+                case detail::holds_schema_or_array:
+                    if (value.is_array ())
+                    {
+                        for (auto&& subschema: value.get_array ())
+                        {
+                            analyse (subschema, base_uri);
+                        }
+                        break;
+                    }
+                    analyse (value, base_uri);
+                    break;
+                // deprecated
+                case detail::holds_dependencies:
+                    for (auto&& [key, subvalue]: value.get_object ())
+                    {
+                        if (subvalue.is_object ())
+                        {
+                            analyse (subvalue, base_uri);
+                        }
+                    }
+                    break;
+                case detail::holds_none:
+                    if (keyword.keyword == detail::kw_pattern)
+                    {
+                        register_regex (value.get_string ());
+                    }
+                    break;
+            }
+        }
+    };
+
+        auto
+    compile (schema_t const& schema)
+        -> detail::compiled_schema_ptr
+    {
+        if (
+                auto
+              node = find_compiled (schema)
+            ; node
+        ){
+            return node;
+        }
+        if (
+                auto&&
+              i = aliases_m.find (&schema)
+            ; i != aliases_m.end ()
+        ){
+                auto
+            node = compile (*i->second);
+            compiled_index_m[&schema] = node;
+            return node;
+        }
+            auto&
+        node = compiled_schemas_m.emplace_back ();
+        // Registered before the keywords are compiled, so that recursive
+        // references find it.
+        compiled_index_m[&schema] = &node;
+        node.schema = &schema;
+        if (schema.is_boolean ())
+        {
+            node.is_boolean = true;
+            node.boolean_value = schema.get_boolean ();
+            return &node;
+        }
+        if (!schema.is_object ())
+        {
+            throw (std::runtime_error { fmt::format (
+                  "{}:{}: Schema \"{}\" is not an object."
+                , __FILE__
+                , __LINE__
+                , to_string (schema)
+            )});
+        }
+            auto const&
+        schema_object = schema.get_object ();
+            auto
+        compile_array = [&](json_t const& value)
+        {
+                std::vector <detail::compiled_schema_ptr>
+            v;
+            v.reserve (value.get_array ().size ());
+            for (auto&& sub_schema: value.get_array ())
+            {
+                v.push_back (compile (sub_schema));
+            }
+            return v;
+        };
+            auto
+        string_views = [](json_t const& value)
+        {
+                std::vector <std::string_view>
+            v;
+            for (auto&& i: value.get_array ())
+            {
+                v.push_back (i.get_string ());
+            }
+            return v;
+        };
+        for (auto&& [name, value]: schema_object)
+        {
+            switch (detail::find_keyword (name).keyword)
+            {
+                case detail::kw_ref:
+                {
+                    node.set (detail::kw_ref);
+                    node.ref_value = &value;
+                    if (
+                            auto&& 
+                          i = registered_references_m.find (&value)
+                        ; i != registered_references_m.end ()
+                    ){
+                        node.ref = compile (*i->second);
+                    }
+                    break;
+                }
+                case detail::kw_all_of:
+                    node.set (detail::kw_all_of);
+                    node.all_of = compile_array (value);
+                    break;
+                case detail::kw_any_of:
+                    node.set (detail::kw_any_of);
+                    node.any_of = compile_array (value);
+                    break;
+                case detail::kw_one_of:
+                    node.set (detail::kw_one_of);
+                    node.one_of = compile_array (value);
+                    break;
+                case detail::kw_not:
+                    node.set (detail::kw_not);
+                    node.not_schema = compile (value);
+                    break;
+                case detail::kw_if:
+                    node.set (detail::kw_if);
+                    node.if_schema = compile (value);
+                    break;
+                case detail::kw_then:
+                    node.set (detail::kw_then);
+                    node.then_schema = compile (value);
+                    break;
+                case detail::kw_else:
+                    node.set (detail::kw_else);
+                    node.else_schema = compile (value);
+                    break;
+                case detail::kw_type:
+                {
+                    node.set (detail::kw_type);
+                    node.type_value = &value;
+                    if (value.is_string ())
+                    {
+                        node.type = detail::type_mask (value.get_string ());
+                    }
+                    else
+                    {
+                        for (auto&& i: value.get_array ())
+                        {
+                            node.type |= detail::type_mask (i.get_string ());
+                        }
+                    }
+                    break;
+                }
+                case detail::kw_enum:
+                {
+                    node.set (detail::kw_enum);
+                    node.enum_values = &value.get_array ();
+                        auto&
+                    set = value_sets_m.emplace_back ();
+                    for (auto&& i: value.get_array ())
+                    {
+                        set.insert (i);
+                    }
+                    node.enum_set = &set;
+                    break;
+                }
+                case detail::kw_const:
+                    node.set (detail::kw_const);
+                    node.const_value = &value;
+                    break;
+                case detail::kw_dependencies:
+                {
+                    node.set (detail::kw_dependencies);
+                    for (auto&& [property, x]: value.get_object ())
+                    {
+                            detail::dependency_t
+                        d;
+                        d.property = &property;
+                        if (x.is_array ())
+                        {
+                            d.required = string_views (x);
+                        }
+                        else
+                        {
+                            d.schema = compile (x);
+                        }
+                        node.dependencies.push_back (std::move (d));
+                    }
+                    break;
+                }
+                case detail::kw_dependent_schemas:
+                {
+                    node.set (detail::kw_dependent_schemas);
+                    for (auto&& [property, sub_schema]: value.get_object ())
+                    {
+                        node.dependent_schemas.emplace_back (&property, compile (sub_schema));
+                    }
+                    break;
+                }
+                case detail::kw_properties:
+                {
+                    node.set (detail::kw_properties);
+                    for (auto&& [property, sub_schema]: value.get_object ())
+                    {
+                        node.properties.emplace (property, compile (sub_schema));
+                    }
+                    break;
+                }
+                case detail::kw_pattern_properties:
+                {
+                    node.set (detail::kw_pattern_properties);
+                    for (auto&& [pattern, sub_schema]: value.get_object ())
+                    {
+                        node.pattern_properties.push_back ({ 
+                              &pattern
+                            , register_regex (pattern)
+                            , compile (sub_schema) 
+                        });
+                    }
+                    break;
+                }
+                case detail::kw_additional_properties:
+                    node.set (detail::kw_additional_properties);
+                    node.additional_properties = compile (value);
+                    break;
+                case detail::kw_property_names:
+                    node.set (detail::kw_property_names);
+                    node.property_names = compile (value);
+                    break;
+                case detail::kw_max_properties:
+                    node.set (detail::kw_max_properties);
+                    node.max_properties = detail::count_from (value);
+                    break;
+                case detail::kw_min_properties:
+                    node.set (detail::kw_min_properties);
+                    node.min_properties = detail::count_from (value);
+                    break;
+                case detail::kw_required:
+                {
+                    node.set (detail::kw_required);
+                    for (auto&& i: value.get_array ())
+                    {
+                        node.required.push_back (&i.get_string ());
+                    }
+                    break;
+                }
+                case detail::kw_dependent_required:
+                {
+                    node.set (detail::kw_dependent_required);
+                    for (auto&& [property, x]: value.get_object ())
+                    {
+                        node.dependent_required.emplace (property, string_views (x));
+                    }
+                    break;
+                }
+                case detail::kw_items:
+                {
+                    node.set (detail::kw_items);
+                    if (value.is_array ())
+                    {
+                        node.items_is_array = true;
+                        node.items_array = compile_array (value);
+                    }
+                    else
+                    {
+                        node.items = compile (value);
+                        node.numeric_items = detail::numeric_items (*node.items);
+                    }
+                    break;
+                }
+                case detail::kw_additional_items:
+                    node.set (detail::kw_additional_items);
+                    node.additional_items = compile (value);
+                    break;
+                case detail::kw_contains:
+                    node.set (detail::kw_contains);
+                    node.contains = compile (value);
+                    break;
+                case detail::kw_max_contains:
+                    node.set (detail::kw_max_contains);
+                    node.max_contains = detail::count_from (value);
+                    break;
+                case detail::kw_min_contains:
+                    node.set (detail::kw_min_contains);
+                    node.min_contains = detail::count_from (value);
+                    break;
+                case detail::kw_max_items:
+                    node.set (detail::kw_max_items);
+                    node.max_items = detail::count_from (value);
+                    break;
+                case detail::kw_min_items:
+                    node.set (detail::kw_min_items);
+                    node.min_items = detail::count_from (value);
+                    break;
+                case detail::kw_unique_items:
+                    node.set (detail::kw_unique_items);
+                    node.unique_items = value.get_boolean ();
+                    break;
+                case detail::kw_multiple_of:
+                    node.set (detail::kw_multiple_of);
+                    node.multiple_of = value.as <double> ();
+                    break;
+                case detail::kw_maximum:
+                    node.set (detail::kw_maximum);
+                    node.maximum = detail::number_t::from (value);
+                    break;
+                case detail::kw_exclusive_maximum:
+                    node.set (detail::kw_exclusive_maximum);
+                    node.exclusive_maximum = detail::number_t::from (value);
+                    break;
+                case detail::kw_minimum:
+                    node.set (detail::kw_minimum);
+                    node.minimum = detail::number_t::from (value);
+                    break;
+                case detail::kw_exclusive_minimum:
+                    node.set (detail::kw_exclusive_minimum);
+                    node.exclusive_minimum = detail::number_t::from (value);
+                    break;
+                case detail::kw_max_length:
+                    node.set (detail::kw_max_length);
+                    node.max_length = detail::count_from (value);
+                    break;
+                case detail::kw_min_length:
+                    node.set (detail::kw_min_length);
+                    node.min_length = detail::count_from (value);
+                    break;
+                case detail::kw_pattern:
+                    node.set (detail::kw_pattern);
+                    node.pattern = &value.get_string ();
+                    node.pattern_regex = register_regex (*node.pattern);
+                    break;
+                case detail::kw_format:
+                    node.set (detail::kw_format);
+                    if (value.is_string ())
+                    {
+                        node.format = detail::formats::format_from (value.get_string ());
+                    }
+                    break;
+                case detail::kw_content_encoding:
+                    node.set (detail::kw_content_encoding);
+                    break;
+                case detail::kw_content_media_type:
+                    node.set (detail::kw_content_media_type);
+                    break;
+                default:
+                    break;
+            }
+        }
+        return &node;
+    }
+
+    // Every analysed sub-schema is compiled, so that validation never has to:
+    // an URI fragment may designate any of them.
+        void
+    compile_pending ()
+    {
+            auto
+        first = compiled_schemas_m.size ();
+        for (auto&& schema: pending_compilation_m)
+        {
+            compile (*schema);
+        }
+        pending_compilation_m.clear ();
+        for (auto&& [alias, shared]: aliases_m)
+        {
+            share_compiled (*alias, *shared);
+        }
+        aliases_m.clear ();
+        // Once the new nodes are complete, look for discriminated unions.
+        for (auto i = first; i < compiled_schemas_m.size (); ++i)
+        {
+                auto&
+            node = compiled_schemas_m[i];
+            if (
+                    auto&&
+                  d = detail::find_discriminator (node.any_of)
+                ; d
+            ){
+                node.any_of_discriminator = &discriminators_m.emplace_back (std::move (*d));
+            }
+            if (
+                    auto&&
+                  d = detail::find_discriminator (node.one_of)
+                ; d
+            ){
+                node.one_of_discriminator = &discriminators_m.emplace_back (std::move (*d));
+            }
+        }
+    }
+
+        auto
+    compiled (schema_t const& schema) const
+        -> const detail::compiled_schema_t&
+    {
+        if (
+                auto
+              node = find_compiled (schema)
+            ; node
+        ){
+            return *node;
+        }
+        throw (std::runtime_error { fmt::format (
+              "{}:{}: \"{}\" is not a registered schema."
+            , __FILE__
+            , __LINE__
+            , to_string (schema)
+        )});
+    }
+
+    // Boolean only evaluation: stops as soon as the result is known and
+    // builds no diagnostics. Within a validation with diagnostics, it shares
+    // the context of the validation: the memoized and traced outcomes are
+    // reused, and the new ones recorded.
+        [[nodiscard]]
+        auto
+    is_valid_impl (
+          const instance_t&                instance
+        , const detail::compiled_schema_t& schema
+        , detail::context_t*               context = nullptr
+    ) const
+        -> bool
+    {
+        if (!context)
+        {
+            return is_valid_keywords (instance, schema, context);
+        }
+        if (schema.is_boolean)
+        {
+            context->count_evaluation ();
+            return schema.boolean_value;
+        }
+            auto
+        remembered = context->unmemoized == 0;
+            auto
+        memoized = remembered && context->memoize;
+            auto
+        trace = remembered ? context->trace : nullptr;
+            std::pair
+        key { &schema, &instance };
+        if (memoized)
+        {
+            if (
+                    auto&&
+                  i = context->outcomes.find (key)
+                ; i != context->outcomes.end ()
+            ){
+                return i->second;
+            }
+            if (
+                    auto&&
+                  i = context->memo.find (key)
+                ; i != context->memo.end ()
+            ){
+                return i->second.first;
+            }
+        }
+        if (trace)
+        {
+            if (
+                    auto
+                  outcome = trace->find (schema, instance)
+                ; outcome
+            ){
+                return *outcome;
+            }
+        }
+        context->count_evaluation ();
+            auto
+        valid = is_valid_keywords (instance, schema, context);
+        if (memoized)
+        {
+            context->outcomes.emplace (key, valid);
+        }
+        if (trace)
+        {
+            trace->record (schema, instance, valid);
+        }
+        return valid;
+    }
+
+        auto
+    is_valid_keywords (
+          const instance_t&                instance
+        , const detail::compiled_schema_t& schema
+        , detail::context_t*               context
+    ) const
+        -> bool
+    {
+        using namespace detail;
+        // Boolean schema
+        if (schema.is_boolean)
+        {
+            return schema.boolean_value;
+        }
+        // Object schema
+        if (schema.has (kw_ref))
+        {
+            if (!schema.ref)
+            {
+                throw (std::runtime_error { fmt::format (
+                      "Resolution of reference \"{}\" failed."
+                    , schema.ref_value->get_string ()
+                )});
+            }
+            return is_valid_impl (instance, *schema.ref, context);
+        }
+        // Keywords for Applying Subschemas in Place
+        if (schema.has (kw_all_of))
+        {
+            for (auto&& sub_schema: schema.all_of)
+            {
+                if (!is_valid_impl (instance, *sub_schema, context))
+                {
+                    return false;
+                }
+            }
+        }
+        if (schema.has (kw_any_of))
+        {
+            if (!any_candidate (
+                  schema.any_of_discriminator
+                , instance
+                , schema.any_of.size ()
+                , [&](auto i){ return is_valid_impl (instance, *schema.any_of[i], context); }
+            )){
+                return false;
+            }
+        }
+        if (schema.has (kw_one_of))
+        {
+                std::size_t
+            successes = 0;
+            if (any_candidate (
+                  schema.one_of_discriminator
+                , instance
+                , schema.one_of.size ()
+                , [&](auto i){ return is_valid_impl (instance, *schema.one_of[i], context) && ++successes > 1; }
+            )){
+                return false;
+            }
+            if (successes != 1)
+            {
+                return false;
+            }
+        }
+        if (schema.has (kw_not))
+        {
+            if (is_valid_impl (instance, *schema.not_schema, context))
+            {
+                return false;
+            }
+        }
+        if (schema.has (kw_if))
+        {
+            if (is_valid_impl (instance, *schema.if_schema, context))
+            {
+                if (schema.has (kw_then) && !is_valid_impl (instance, *schema.then_schema, context))
+                {
+                    return false;
+                }
+            }
+            else
+            {
+                if (schema.has (kw_else) && !is_valid_impl (instance, *schema.else_schema, context))
+                {
+                    return false;
+                }
+            }
+        }
+        // Validation Keywords for Any Instance Type
+        if (schema.has (kw_type))
+        {
+            if (!(schema.type & type_mask (instance)))
+            {
+                return false;
+            }
+        }
+        if (schema.has (kw_enum))
+        {
+            if (!schema.enum_set->contains (instance))
+            {
+                return false;
+            }
+        }
+        if (schema.has (kw_const))
+        {
+            if (instance != *schema.const_value)
+            {
+                return false;
+            }
+        }
+        // Instance is an object
+        if (instance.is_object ())
+        {
+                auto&
+            instance_object = instance.get_object ();
+            // DEPRECATED in draft-08 XXX
+            if (schema.has (kw_dependencies))
+            {
+                for (auto&& dependency: schema.dependencies)
+                {
+                    if (instance_object.count (*dependency.property) == 0)
+                    {
+                        continue;
+                    }
+                    if (!dependency.schema)
+                    {
+                        for (auto&& i: dependency.required)
+                        {
+                            if (instance_object.count (i) < 1)
+                            {
+                                return false;
+                            }
+                        }
+                    }
+                    else if (!is_valid_impl (instance, *dependency.schema, context))
+                    {
+                        return false;
+                    }
+                }
+            }
+            // end of deprecated section XXX
+            if (schema.has (kw_dependent_schemas))
+            {
+                for (auto&& [property, sub_schema]: schema.dependent_schemas)
+                {
+                    if (
+                           instance_object.count (*property) > 0
+                        && !is_valid_impl (instance, *sub_schema, context)
+                    ){
+                        return false;
+                    }
+                }
+            }
+            if (schema.has (kw_max_properties))
+            {
+                if (instance_object.size () > schema.max_properties)
+                {
+                    return false;
+                }
+            }
+            if (schema.has (kw_min_properties))
+            {
+                if (instance_object.size () < schema.min_properties)
+                {
+                    return false;
+                }
+            }
+            if (schema.has (kw_required))
+            {
+                for (auto&& property: schema.required)
+                {
+                    if (instance_object.count (*property) == 0)
+                    {
+                        return false;
+                    }
+                }
+            }
+            if (schema.has (kw_dependent_required))
+            {
+                for (auto&& [property, value]: instance_object)
+                {
+                    if (
+                          auto&& array = schema.dependent_required.find (property)
+                        ; array != schema.dependent_required.end ()
+                    ){
+                        for (auto&& dependent_property: array->second)
+                        {
+                            if (instance_object.count (dependent_property) < 1)
+                            {
+                                return false;
+                            }
+                        }
+                    }
+                }
+            }
+            if (schema.has (kw_properties)
+                || schema.has (kw_pattern_properties)
+                || schema.has (kw_additional_properties)
+                || schema.has (kw_property_names)
+            ){
+                for (auto&& [property, value]: instance_object)
+                {
+                        bool
+                    apply_additional = true;
+                    if (
+                            auto&&
+                          i = schema.properties.find (property)
+                        ; i != schema.properties.end ()
+                    ){
+                        if (!is_valid_impl (value, *i->second, context))
+                        {
+                            return false;
+                        }
+                        apply_additional = false;
+                    }
+                    for (auto&& [pattern, regex, sub_schema]: schema.pattern_properties)
+                    {
+                        if (std::regex_search (property, *regex))
+                        {
+                            if (!is_valid_impl (value, *sub_schema, context))
+                            {
+                                return false;
+                            }
+                            apply_additional = false;
+                        }
+                    }
+                    if (
+                           apply_additional 
+                        && schema.additional_properties
+                        && !is_valid_impl (value, *schema.additional_properties, context)
+                    ){
+                        return false;
+                    }
+                    // The name is a temporary: it is neither memoized nor
+                    // traced.
+                    if (schema.property_names)
+                    {
+                        if (context)
+                        {
+                            ++context->unmemoized;
+                        }
+                            auto
+                        valid = is_valid_impl (property, *schema.property_names, context);
+                        if (context)
+                        {
+                            --context->unmemoized;
+                        }
+                        if (!valid)
+                        {
+                            return false;
+                        }
+                    }
+                }
+            }
         }
-        if (
-              it = schema_object.find ("$ref")
-            ; it != schema_object.end ()
-                && registered_references_m.count (&(it->second)) == 0
-        ){
-                auto&
-            ref = it->second;
+        // Instance is an array
+        if (instance.is_array ())
+        {
                 auto&
-            ref_string = ref.get_string ();
-                auto
-            [ schema, uri ] = resolve_reference (ref_string, base_uri);
-            register_reference (ref, *schema);
-            // Some references might point to places whe do not analyse.
-            if (analysed_schemas_m.count (schema) == 0) 
+            instance_array = instance.get_array ();
+            if (schema.has (kw_max_items))
             {
-                analyse (*schema, uri);
+                if (instance_array.size () > schema.max_items)
+                {
+                    return false;
+                }
             }
-        }
-        for (auto&& [name, value]: schema_object)
-        {
-                const std::unordered_set <std::string>
-            contains_a_schema 
+            if (schema.has (kw_min_items))
             {
-                  "not"                  
-                , "if"                   
-                , "then"                 
-                , "else"                 
-                , "additionalProperties" 
-                , "propertyNames"        
-                , "additionalItems"      
-                , "contains"             
-            };
-                const std::unordered_set <std::string>
-            contains_an_object_of_schemas
+                if (instance_array.size () < schema.min_items)
+                {
+                    return false;
+                }
+            }
+            if (schema.has (kw_items))
             {
-                  "$defs"                
-                , "definitions"          // deprecated
-                , "dependentSchemas"     
-                , "properties"           
-                , "patternProperties"    
-            };
-                const std::unordered_set <std::string>
-            contains_an_array_of_schemas
+                    std::size_t
+                index = 0;
+                if (schema.items_is_array)
+                {
+                    for (; 
+                             index < instance_array.size () 
+                          && index < schema.items_array.size ()
+                        ; ++index
+                    ){
+                        if (!is_valid_impl (instance_array[index], *schema.items_array[index], context))
+                        {
+                            return false;
+                        }
+                    }
+                }
+                else if (schema.numeric_items && instance_array.size () >= bulk_check_minimum)
+                {
+                    // The items the bulk check passes count as visited.
+                        std::size_t
+                    flagged = 0;
+                        std::size_t
+                    checked = instance_array.size ();
+                        auto
+                    valid = check_numeric_items (instance_array, *schema.numeric_items, [&](std::size_t i)
+                    {
+                        ++flagged;
+                        checked = i + 1;
+                        return is_valid_impl (instance_array[i], *schema.items, context);
+                    });
+                    if (context)
+                    {
+                        context->visited += (valid ? instance_array.size () : checked) - flagged;
+                    }
+                    if (!valid)
+                    {
+                        return false;
+                    }
+                    index = instance_array.size ();
+                }
+                else
+                {
+                    for (; index < instance_array.size (); ++index)
+                    {
+                        if (!is_valid_impl (instance_array[index], *schema.items, context))
+                        {
+                            return false;
+                        }
+                    }
+                }
+                if (schema.has (kw_additional_items))
+                {
+                    for (; index < instance_array.size (); ++index)
+                    {
+                        if (!is_valid_impl (instance_array[index], *schema.additional_items, context))
+                        {
+                            return false;
+                        }
+                    }
+                }
+            }
+            if (schema.has (kw_contains))
             {
-                  "allOf"                
-                , "anyOf"                
-                , "oneOf"                
-            };
-            if (contains_a_schema.count (name) > 0) 
+                    std::size_t
+                contains_count = 0;
+                for (auto&& i: instance_array)
+                {
+                    if (is_valid_impl (i, *schema.contains, context))
+                    {
+                        ++contains_count;
+                    }
+                }
+                if (
+                       contains_count == 0
+                    || (schema.has (kw_max_contains) && contains_count > schema.max_contains)
+                    || (schema.has (kw_min_contains) && contains_count < schema.min_contains)
+                ){
+                    return false;
+                }
+            }
+            if (schema.has (kw_unique_items))
             {
-                analyse (value, base_uri);
-                continue;
+                if (schema.unique_items && has_duplicates (instance_array))
+                {
+                    return false;
+                }
             }
-            if (contains_an_object_of_schemas.count (name) > 0) 
+        }
+        // Instance is a number
+        if (instance.is_number ())
+        {
+            if (schema.has (kw_multiple_of))
             {
-                for (auto&& [key, subschema]: value.get_object ())
+                if (remainder (instance.as <double> (), schema.multiple_of) != 0)
                 {
-                    analyse (subschema, base_uri);
+                    return false;
                 }
-                continue;
             }
-            if (contains_an_array_of_schemas.count (name) > 0) 
+            if (
+                   (schema.has (kw_maximum) && compare (instance, schema.maximum) > 0)
+                || (schema.has (kw_exclusive_maximum) && compare (instance, schema.exclusive_maximum) >= 0)
+                || (schema.has (kw_minimum) && compare (instance, schema.minimum) < 0)
+                || (schema.has (kw_exclusive_minimum) && compare (instance, schema.exclusive_minimum) <= 0)
+            ){
+                return false;
+            }
+        }
+        // Instance is a string
+        if (instance.is_string ())
+        {
+            if (schema.has (kw_max_length))
             {
-                    int
-                i = 0;
-                for (auto&& subschema: value.get_array ())
+                if (longer_than (instance.get_string (), schema.max_length))
                 {
-                    analyse (subschema, base_uri);
-                    ++i;
+                    return false;
                 }
-                continue;
             }
-            // deprecated
-            if (name == "dependencies")
+            if (schema.has (kw_min_length))
             {
-                for (auto&& [key, subvalue]: value.get_object ())
+                if (shorter_than (instance.get_string (), schema.min_length))
                 {
-                    if (subvalue.is_object ())
-                    {
-                        analyse (subvalue, base_uri);
-                    }
+                    return false;
                 }
             }
-            if (name == "items")
+            if (schema.has (kw_pattern))
             {
-                if (value.is_array ())
+                if (!std::regex_search (instance.get_string (), *schema.pattern_regex))
                 {
-                        int
-                    i = 0;
-                    for (auto&& subschema: value.get_array ())
-                    {
-                        analyse (subschema, base_uri);
-                        ++i;
-                    }
-                    continue;
+                    return false;
                 }
-                analyse (value, base_uri);
-                continue;
+            }
+            if (
+                   assert_formats_m
+                && schema.format != formats::format_t::unknown
+                && !formats::check (schema.format, instance.get_string ())
+            ){
+                return false;
             }
         }
-    };
+        return true;
+    }
 
+    // Validation with diagnostics. A frame stops at its first failing
+    // keyword: only that one is reported.
         [[nodiscard]]
         auto
     validate_impl (
-          const instance_t&  instance
-        , const std::string& instance_location
-        , const schema_t&    schema
-        , const std::string& schema_location
-    )
-        -> std::pair <bool, json_t>
+          const instance_t&                instance
+        , const detail::compiled_schema_t& schema
+        , detail::context_t&               context
+    ) const
+        -> std::pair <bool, detail::error_id_t>
     {
-            auto
-        state = true;
-            json_t
-        errors = tao::json::null;
+        using namespace detail;
+            using
+        segment = location_segment_t;
             auto
         report = [&](
-              std::string const& sub_schema_location
-            , std::string const& message
-            , json_t const& sub_schema_errors = tao::json::null
-        ){
-            state = false;
-                json_t
-            v = {
-                  { "schemaLocation", schema_location + sub_schema_location }
-                , { "instanceLocation", instance_location }
-                , { "message" , message }
-            };
-            if (!sub_schema_errors.is_null ())
+              segment const&           sub_schema_location
+            , std::string              message
+            , error_entry_t::kind_t    kind = error_entry_t::leaf
+            , std::vector <error_id_t> sub_schema_errors = {}
+        )
+            -> std::pair <bool, error_id_t>
+        {
+            return { false, context.record (
+                  kind
+                , sub_schema_location
+                , std::move (message)
+                , std::move (sub_schema_errors)
+            )};
+        };
+            auto
+        traced = [&]
+        {
+            return context.unmemoized == 0 ? context.trace : nullptr;
+        };
+            auto
+        descend = [&](
+              const instance_t&        sub_instance
+            , segment const&           instance_segment
+            , const compiled_schema_t& sub_schema
+            , segment const&           schema_segment
+            , std::size_t              kept = 0
+        )
+            -> std::pair <bool, error_id_t>
+        {
+                auto
+            memoized = context.memoize && context.unmemoized == 0;
+            if (memoized)
             {
-                v["errors"] = sub_schema_errors;
+                if (
+                        auto&&
+                      i = context.memo.find ({ &sub_schema, &sub_instance })
+                    ; i != context.memo.end ()
+                ){
+                    return i->second;
+                }
             }
-            if (errors.is_null ())
+                auto
+            trace = traced ();
+            // Only a success can be reused: a failure is evaluated again,
+            // for its errors.
+            if (memoized)
             {
-                errors = v;
-                return;
+                if (
+                        auto&&
+                      i = context.outcomes.find ({ &sub_schema, &sub_instance })
+                    ; i != context.outcomes.end () && i->second
+                ){
+                    return { true, no_error };
+                }
             }
-            if (errors.is_array ())
+            if (trace)
             {
-                errors.push_back (v);
-                return;
+                if (trace->find (sub_schema, sub_instance) == true)
+                {
+                    return { true, no_error };
+                }
             }
+            // Past the error budget, only the outcome is computed.
+            if (context.over_budget (kept))
+            {
+                if (is_valid_impl (sub_instance, sub_schema, &context))
+                {
+                    return { true, no_error };
+                }
+                ++context.suppressed;
+                return { false, no_error };
+            }
+            context.instance_path.push_back (instance_segment);
+            context.schema_path.push_back (schema_segment);
+                auto
+            result = validate_impl (sub_instance, sub_schema, context);
+            context.instance_path.pop_back ();
+            context.schema_path.pop_back ();
+            if (memoized)
+            {
+                context.memo.emplace (std::pair { &sub_schema, &sub_instance }, result);
+            }
+            if (trace)
+            {
+                trace->record (sub_schema, sub_instance, result.first);
+            }
+            return result;
         };
 
+        ++context.visited;
+            frame_probe_t
+        frame_probe { context };
         // Boolean schema
-        if (schema.is_boolean ())
+        if (schema.is_boolean)
         {
-                auto
-            value = schema.get_boolean ();
-            return { 
-                  schema.get_boolean ()
-                , value
-                    ? tao::json::null
-                    : tao::json::from_string (R"("boolean schema is false")")
-            };
+            if (schema.boolean_value)
+            {
+                return { true, no_error };
+            }
+            return { false, context.record (error_entry_t::boolean_schema) };
         }
         // Object schema
-            auto&
-        schema_object = schema.get_object ();
-            json_t::object_t::const_iterator
-        it;
-        if (
-              it = schema_object.find ("$ref")
-            ; it != schema_object.end ()
-        ){
-                auto&
-            ref = it->second;
-            if (
-                    auto&& 
-                  i = registered_references_m.find (&ref)
-                ; i != registered_references_m.end ()
-            ){
-                    auto&
-                schema = i->second;
-                if (
-                        auto&&
-                      [is_valid, e] = validate_impl (
-                          instance
-                        , instance_location
-                        , *schema
-                        , schema_location + "/$ref"
-                      )
-                    ; !is_valid
-                ){
-                    report (
-                          "/$ref"
-                        , "Sub-schema does not validates the instance" 
-                        , e
-                    );
-                }
-            }
-            else
+        if (schema.has (kw_ref))
+        {
+                keyword_probe_t
+            keyword_probe { context, kw_ref };
+            if (!schema.ref)
             {
                 throw (std::runtime_error { fmt::format (
                       "Resolution of reference \"{}\" failed."
-                    , ref.get_string ()
+                    , schema.ref_value->get_string ()
                 )});
             }
-            return { state, errors };
+            if (
+                    auto&&
+                  [is_valid, e] = descend (instance, {}, *schema.ref, { "/$ref" })
+                ; !is_valid
+            ){
+                return report (
+                      { "/$ref" }
+                    , "Sub-schema does not validates the instance" 
+                    , error_entry_t::single
+                    , { e }
+                );
+            }
+            return { true, no_error };
         }
         // Keywords for Applying Subschemas in Place
-        if (
-              it = schema_object.find ("allOf")
-            ; it != schema_object.end ()
-        ){
+        if (schema.has (kw_all_of))
+        {
+                keyword_probe_t
+            keyword_probe { context, kw_all_of };
                 std::size_t
             index = 0;
                 std::vector <std::size_t>
             failures;
-                json_t::array_t
+                std::vector <error_id_t>
             sub_errors;
-            for (auto&& sub_schema: it->second.get_array ())
+            for (auto&& sub_schema: schema.all_of)
             {
                 if (
-                      auto&& [is_valid, e] = validate_impl (
+                      auto&& [is_valid, e] = descend (
                           instance
-                        , instance_location
-                        , sub_schema
-                        , schema_location + fmt::format ("/allOf/{}", index)
+                        , {}
+                        , *sub_schema
+                        , { "/allOf/", nullptr, index }
+                        , sub_errors.size ()
                       )
                       ; !is_valid
                 ){
                     failures.push_back (index);
-                    sub_errors.push_back (std::move (e));
-                    //detail::concatenate (sub_errors, std::move (e));
+                    sub_errors.push_back (e);
                 }
                 ++index;
             }
             if (!failures.empty ())
             {
-                report (
-                      "/allof"
+                return report (
+                      { "/allof" }
                     , fmt::format ("not all sub-schemas validate the instance: ", failures)
-                    , sub_errors
+                    , error_entry_t::array
+                    , std::move (sub_errors)
                 );
             }
         }
-        if (
-              it = schema_object.find ("anyOf")
-            ; it != schema_object.end ()
-        ){
-                std::size_t
-            index = 0;
-                bool
-            is_any_valid;
-            for (auto&& sub_schema: it->second.get_array ())
-            {
-                std::tie (is_any_valid, std::ignore) = validate_impl (
-                      instance
-                    , instance_location
-                    , sub_schema
-                    , schema_location + fmt::format ("/anyOf/{}", index)
-                );
-                if (is_any_valid){
-                    break;
-                };
-                ++index;
-            }
-            if (!is_any_valid)
-            {
-                report (
-                      "/anyOf"
+        if (schema.has (kw_any_of))
+        {
+                keyword_probe_t
+            keyword_probe { context, kw_any_of };
+            if (!any_candidate (
+                  schema.any_of_discriminator
+                , instance
+                , schema.any_of.size ()
+                , [&](auto i){ return is_valid_impl (instance, *schema.any_of[i], &context); }
+            )){
+                return report (
+                      { "/anyOf" }
                     , "No sub-schema validate the instance"
                 );
             }
         }
-        if (
-              it = schema_object.find ("oneOf")
-            ; it != schema_object.end ()
-        ){
-                std::size_t
-            index = 0;
+        if (schema.has (kw_one_of))
+        {
+                keyword_probe_t
+            keyword_probe { context, kw_one_of };
                 std::vector <std::size_t>
             successes;
-                json_t::array_t
-            sub_errors;
-            for (auto&& sub_schema: it->second.get_array ())
+            any_candidate (
+                  schema.one_of_discriminator
+                , instance
+                , schema.one_of.size ()
+                , [&](auto i)
+                  {
+                      if (is_valid_impl (instance, *schema.one_of[i], &context))
+                      {
+                          successes.push_back (i);
+                      }
+                      return false;
+                  }
+            );
+            if (successes.size () != 1)
             {
-                    auto&&
-                [is_valid, e] = validate_impl (
-                      instance
-                    , instance_location
-                    , sub_schema
-                    , schema_location + fmt::format ("/oneOf/{}", index)
-                );
-                if (is_valid){
-                    successes.push_back (index);
-                }
-                else
+                // The failing branches are only walked again, for their
+                // errors, when the keyword fails. With a discriminator, only
+                // the candidates are, unless there are none.
+                    auto
+                candidates = candidate_branches (schema.one_of_discriminator, instance);
+                    std::vector <error_id_t>
+                sub_errors;
+                for (std::size_t index = 0; index < schema.one_of.size (); ++index)
                 {
-                    sub_errors.push_back (std::move (e));
+                    if (
+                           candidates
+                        && !candidates->empty ()
+                        && std::find (
+                              std::begin (*candidates)
+                            , std::end (*candidates)
+                            , index
+                           ) == std::end (*candidates)
+                    ){
+                        continue;
+                    }
+                    if (std::find (
+                          std::begin (successes)
+                        , std::end (successes)
+                        , index
+                    ) != std::end (successes)){
+                        continue;
+                    }
+                    sub_errors.push_back (descend (
+                          instance
+                        , {}
+                        , *schema.one_of[index]
+                        , { "/oneOf/", nullptr, index }
+                        , sub_errors.size ()
+                    ).second);
                 }
-                ++index;
-            }
-            if (successes.size () != 1)
-            {
-                report (
-                      "/oneOf"
+                return report (
+                      { "/oneOf" }
                     , successes.size () == 0 
                         ? "No sub-schema validate the instance" 
                         : fmt::format (
                               "More than one sub-schema validate the instance: {}" 
                             , successes
                           )
-                    , sub_errors
+                    , error_entry_t::array
+                    , std::move (sub_errors)
                 );
             }
         }
-        if (
-              it = schema_object.find ("not")
-            ; it != schema_object.end ()
-        ){
-            if (
-                  auto&& [is_valid, e] = validate_impl (
-                      instance
-                    , instance_location
-                    , it->second
-                    , schema_location + "/not"
-                  )
-                ; is_valid
-            ){
-                report (
-                      "/not"
+        if (schema.has (kw_not))
+        {
+                keyword_probe_t
+            keyword_probe { context, kw_not };
+            if (is_valid_impl (instance, *schema.not_schema, &context))
+            {
+                return report (
+                      { "/not" }
                     , "Sub-schema validates the instance" 
                 );
             }
-
         }
-        if (
-              it = schema_object.find ("if")
-            ; it != schema_object.end ()
-        ){
-            if (
-                    auto&& 
-                  [is_valid, e] = validate_impl (
-                      instance
-                    , instance_location
-                    , it->second
-                    , schema_location + "/if"
-                  )
-                ; is_valid
-            ){
-                if (
-                      it = schema_object.find ("then")
-                    ; it != schema_object.end ()
-                ){
+        if (schema.has (kw_if))
+        {
+                keyword_probe_t
+            keyword_probe { context, kw_if };
+            if (is_valid_impl (instance, *schema.if_schema, &context))
+            {
+                if (schema.has (kw_then))
+                {
                     if (
                             auto&&
-                          [is_valid, e] =validate_impl (
+                          [is_valid, e] = descend (
                               instance
-                            , instance_location
-                            , it->second
-                            , schema_location + "/then"
+                            , {}
+                            , *schema.then_schema
+                            , { "/then" }
                           )
                         ; !is_valid
                     ){
-                        report (
-                              "/then"
+                        return report (
+                              { "/then" }
                             , "Sub-schema does not validates the instance" 
-                            , e
+                            , error_entry_t::single
+                            , { e }
                         );
                     }
                 }
             }
             else
             {
-                if (
-                      it = schema_object.find ("else")
-                    ; it != schema_object.end ()
-                ){
+                if (schema.has (kw_else))
+                {
                     if (
                             auto&&
-                          [is_valid, e] = validate_impl (
+                          [is_valid, e] = descend (
                               instance
-                            , instance_location
-                            , it->second
-                            , schema_location + "/then"
+                            , {}
+                            , *schema.else_schema
+                            , { "/then" }
                           )
                         ; !is_valid
                     ){
-                        report (
-                              "/then"
+                        return report (
+                              { "/then" }
                             , "Sub-schema does not validates the instance" 
-                            , e
+                            , error_entry_t::single
+                            , { e }
                         );
                     }
                 }
             }
-            
         }
         // Validation Keywords for Any Instance Type
-        if (
-              it = schema_object.find ("type")
-            ; it != schema_object.end ()
-        ){
-            if (it->second.is_string ())
+        if (schema.has (kw_type))
+        {
+                keyword_probe_t
+            keyword_probe { context, kw_type };
+            if (!(schema.type & type_mask (instance)))
             {
-                if (!detail::type_match (it->second, instance))
+                if (schema.type_value->is_string ())
                 {
-                    report (
-                          "/type"
+                    return report (
+                          { "/type" }
                         , fmt::format (
                               "Type mismatch, schema requires {}, got {}" 
-                            , it->second.get_string ()
+                            , schema.type_value->get_string ()
                             , tao::json::to_string (instance.type ())
                           )
                     );
                 }
-            }
-            else
-            {
-                    auto&
-                type_array = it->second.get_array ();
-                    bool
-                r = std::any_of (
-                      std::begin (type_array)
-                    , std::end   (type_array)
-                    , [&](auto x){ return detail::type_match (x, instance); }
+                return report (
+                     { "/type" }
+                    , fmt::format (
+                          "Type mismatch, schema requires one of {}, instance is \"{}\""
+                        , schema.type_value->get_array ()
+                        , tao::json::to_string (instance.type ())
+                      )
                 );
-                if (!r)
-                {
-                    report (
-                         "/type"
-                        , fmt::format (
-                              "Type mismatch, schema requires one of {}, instance is \"{}\""
-                            , it->second.get_array ()
-                            , tao::json::to_string (instance.type ())
-                          )
-                    );
-                }
             }
         }
-        if (
-              it = schema_object.find ("enum")
-            ; it != schema_object.end ()
-        ){
-                auto&
-            array = it->second.get_array ();
-            if (!std::any_of (
-                  std::begin (array)
-                , std::end (array)
-                , [&](auto&& x){ return instance == x; }
-            )){
-                report ("/enum", "Value no in enum");
+        if (schema.has (kw_enum))
+        {
+                keyword_probe_t
+            keyword_probe { context, kw_enum };
+            if (!schema.enum_set->contains (instance))
+            {
+                return report ({ "/enum" }, "Value no in enum");
             }
         }
-        if (
-              it = schema_object.find ("const")
-            ; it != schema_object.end ()
-        ){
-            if (instance != it->second)
+        if (schema.has (kw_const))
+        {
+                keyword_probe_t
+            keyword_probe { context, kw_const };
+            if (instance != *schema.const_value)
             {
-                report ("/const", "Value does not match \"const\"");
+                return report ({ "/const" }, "Value does not match \"const\"");
             }
         }
 
@@ -701,263 +3833,256 @@ private:
                 auto&
             instance_object = instance.get_object ();
             // DEPRECATED in draft-08 XXX
-            if (
-                  it = schema_object.find ("dependencies")
-                ; it != schema_object.end ()
-            ){
-                    json_t::array_t
+            if (schema.has (kw_dependencies))
+            {
+                    keyword_probe_t
+                keyword_probe { context, kw_dependencies };
+                    std::vector <error_id_t>
                 sub_errors;
                     std::vector <std::string>
                 failures;
-                for (auto&& [property, x]: it->second.get_object ())
+                for (auto&& dependency: schema.dependencies)
                 {
-                    if (x.is_array ())
+                        auto&
+                    property = *dependency.property;
+                    if (instance_object.count (property) == 0)
+                    {
+                        continue;
+                    }
+                    if (!dependency.schema)
                     {
-                        if (instance_object.count (property) > 0)
+                        for (auto&& i: dependency.required)
                         {
-                            for (auto&& i: x.get_array ())
+                            if (instance_object.count (i) < 1)
                             {
-                                if (instance_object.count (i.get_string ()) < 1)
-                                {
-                                    failures.push_back (property);
-                                }
+                                failures.push_back (property);
                             }
                         }
                     }
                     else
                     {
-                        if (instance_object.count (property) > 0)
-                        {
-                            if (
-                                    auto&&
-                                  [is_valid, e] = validate_impl (
-                                      instance
-                                    , instance_location
-                                    , x
-                                    , schema_location + fmt::format ("/dependencies/{}", property)
-                                  )
-                                ; !is_valid
-                            ){
-                                failures.push_back (property);
-                                sub_errors.push_back (std::move (e));
-                                //detail::concatenate (sub_errors, std::move (e));
-                            }
+                        if (
+                                auto&&
+                              [is_valid, e] = descend (
+                                  instance
+                                , {}
+                                , *dependency.schema
+                                , { "/dependencies/", &property }
+                                , sub_errors.size ()
+                              )
+                            ; !is_valid
+                        ){
+                            failures.push_back (property);
+                            sub_errors.push_back (e);
                         }
-
                     }
                 }
                 if (!failures.empty ())
                 {
-                    report (
-                          "/dependencies"
+                    return report (
+                          { "/dependencies" }
                         , fmt::format ("not all dependencies validate the instance: ", failures)
-                        , sub_errors
+                        , error_entry_t::array
+                        , std::move (sub_errors)
                     );
                 }
             }
             // end of deprecated section XXX
-            if (
-                  it = schema_object.find ("dependentSchemas")
-                ; it != schema_object.end ()
-            ){
-                    json_t::array_t
+            if (schema.has (kw_dependent_schemas))
+            {
+                    keyword_probe_t
+                keyword_probe { context, kw_dependent_schemas };
+                    std::vector <error_id_t>
                 sub_errors;
                     std::vector <std::string>
                 failures;
-                for (auto&& [property, sub_schema]: it->second.get_object ())
+                for (auto&& [property, sub_schema]: schema.dependent_schemas)
                 {
-                    if (instance_object.count (property) > 0)
+                    if (instance_object.count (*property) > 0)
                     {
                         if (
                                 auto&&
-                              [is_valid, e] = validate_impl (
+                              [is_valid, e] = descend (
                                   instance
-                                , instance_location
-                                , sub_schema
-                                , schema_location + fmt::format ("/dependentSchemas/{}", property)
+                                , {}
+                                , *sub_schema
+                                , { "/dependentSchemas/", property }
+                                , sub_errors.size ()
                               )
                             ; !is_valid
                         ){
-                            failures.push_back (property);
-                            sub_errors.push_back (std::move (e));
-                            //detail::concatenate (sub_errors, std::move (e));
+                            failures.push_back (*property);
+                            sub_errors.push_back (e);
                         }
                     }
                 }
                 if (!failures.empty ())
                 {
-                    report (
-                          "/dependentSchemas"
+                    return report (
+                          { "/dependentSchemas" }
                         , fmt::format ("not all dependent sub-schemas validate the instance: ", failures)
-                        , sub_errors
+                        , error_entry_t::array
+                        , std::move (sub_errors)
                     );
                 }
             }
-                auto
-            get_object_if_property_exists = [&](std::string const& name) 
-                -> const json_t::object_t*
-            {
-                    const json_t*
-                p = schema.find (name);
-                return p ? &(p->get_object ()) : nullptr;
-            };
-                const json_t::object_t*
-            properties = get_object_if_property_exists ("properties");
-                const json_t::object_t*
-            pattern_properties = get_object_if_property_exists ("patternProperties");
-                const json_t*
-            additional_properties = schema.find ("additionalProperties");
-                const json_t*
-            property_names = schema.find ("propertyNames");
-            for (auto&& [property, value]: instance_object)
-            {
-                    bool
-                apply_additional = true;
-                if (properties && properties->count (property) > 0)
+            if (schema.has (kw_properties)
+                || schema.has (kw_pattern_properties)
+                || schema.has (kw_additional_properties)
+                || schema.has (kw_property_names)
+            ){
+                // Profiled as "properties".
+                    keyword_probe_t
+                keyword_probe { context, kw_properties };
+                for (auto&& [property, value]: instance_object)
                 {
+                        bool
+                    apply_additional = true;
                     if (
                             auto&&
-                          [is_valid, e] = validate_impl (
-                              value
-                            , instance_location + "/" + property
-                            , properties->at (property)
-                            , schema_location + "/properties/" + property
-                          )
-                        ; !is_valid
+                          i = schema.properties.find (property)
+                        ; i != schema.properties.end ()
                     ){
-                        report (
-                              "/properties/" + property
-                            , "Sub-schema does not validates the instance" 
-                            , e
-                        );
+                        if (
+                                auto&&
+                              [is_valid, e] = descend (
+                                  value
+                                , { "/", &property }
+                                , *i->second
+                                , { "/properties/", &property }
+                              )
+                            ; !is_valid
+                        ){
+                            return report (
+                                  { "/properties/", &property }
+                                , "Sub-schema does not validates the instance" 
+                                , error_entry_t::single
+                                , { e }
+                            );
+                        }
+                        apply_additional = false;
                     }
-                    apply_additional = false;
-                }
-                if (pattern_properties)
-                {
-                    for (auto&& [pattern, schema]: *pattern_properties)
+                    for (auto&& [pattern, regex, sub_schema]: schema.pattern_properties)
                     {
-                            std::regex
-                        re { pattern };
-                        if (std::regex_search (property, re))
+                        if (std::regex_search (property, *regex))
                         {
                             if (
                                     auto&&
-                                  [is_valid, e] = validate_impl (
+                                  [is_valid, e] = descend (
                                       value
-                                    , instance_location + "/" + property
-                                    , schema
-                                    , schema_location + "/patternProperties/" + pattern
+                                    , { "/", &property }
+                                    , *sub_schema
+                                    , { "/patternProperties/", pattern }
                                   )
                                 ; !is_valid
                             ){
-                                report (
-                                      "/patternProperties/" + pattern
+                                return report (
+                                      { "/patternProperties/", pattern }
                                     , "Sub-schema does not validates the instance" 
-                                    , e
+                                    , error_entry_t::single
+                                    , { e }
                                 );
                             }
                             apply_additional = false;
                         }
                     }
-                }
-                if (apply_additional && additional_properties)
-                {
-                    if (
-                            auto&&
-                          [is_valid, e] = validate_impl (
-                              value
-                            , instance_location + "/" + property
-                            , *additional_properties
-                            , schema_location + "/additionalProperties"
-                          )
-                        ; !is_valid
-                    ){
-                        report (
-                              "/additionalProperties"
-                            , "Sub-schema does not validates the instance" 
-                            , e
-                        );
+                    if (apply_additional && schema.additional_properties)
+                    {
+                        if (
+                                auto&&
+                              [is_valid, e] = descend (
+                                  value
+                                , { "/", &property }
+                                , *schema.additional_properties
+                                , { "/additionalProperties" }
+                              )
+                            ; !is_valid
+                        ){
+                            return report (
+                                  { "/additionalProperties" }
+                                , "Sub-schema does not validates the instance" 
+                                , error_entry_t::single
+                                , { e }
+                            );
+                        }
                     }
-                }
-                if (property_names)
-                {
-                    if (
-                            auto&&
-                          [is_valid, e] = validate_impl (
+                    if (schema.property_names)
+                    {
+                        // The name is validated as a temporary, whose
+                        // address is no key.
+                        ++context.unmemoized;
+                            auto
+                        [is_valid, e] = descend (
                               property
-                            , instance_location + "/" + property
-                            , *property_names
-                            , schema_location + "/propertyNames"
-                          )
-                        ; !is_valid
-                    ){
-                        report (
-                              "/propertyNames"
-                            , "Sub-schema does not validates the instance" 
-                            , e
+                            , { "/", &property }
+                            , *schema.property_names
+                            , { "/propertyNames" }
                         );
+                        --context.unmemoized;
+                        if (!is_valid)
+                        {
+                            return report (
+                                  { "/propertyNames" }
+                                , "Sub-schema does not validates the instance" 
+                                , error_entry_t::single
+                                , { e }
+                            );
+                        }
                     }
                 }
             }
-            if (
-                  it = schema_object.find ("maxProperties")
-                ; it != schema_object.end ()
-            ){
-                if (instance_object.size () > it->second.get_unsigned ())
+            if (schema.has (kw_max_properties))
+            {
+                    keyword_probe_t
+                keyword_probe { context, kw_max_properties };
+                if (instance_object.size () > schema.max_properties)
                 {
-                    report ("maxProperties", "Object has too many properties");
+                    return report ({ "maxProperties" }, "Object has too many properties");
                 }
             }
-            if (
-                  it = schema_object.find ("minProperties")
-                ; it != schema_object.end ()
-            ){
-                if (instance_object.size () < it->second.get_unsigned ())
+            if (schema.has (kw_min_properties))
+            {
+                    keyword_probe_t
+                keyword_probe { context, kw_min_properties };
+                if (instance_object.size () < schema.min_properties)
                 {
-                    report ("minProperties", "Object has too few properties");
+                    return report ({ "minProperties" }, "Object has too few properties");
                 }
             }
-            if (
-                  it = schema_object.find ("required")
-                ; it != schema_object.end ()
-            ){
+            if (schema.has (kw_required))
+            {
+                    keyword_probe_t
+                keyword_probe { context, kw_required };
                     std::size_t
                 index = 0;
-                for (auto&& i: it->second.get_array ())
+                for (auto&& property: schema.required)
                 {
-                        auto&
-                    property = i.get_string ();
-                    if (instance_object.count (property) == 0)
+                    if (instance_object.count (*property) == 0)
                     {
-                        report (
-                              fmt::format ("/required/{}", index)
-                            , fmt::format ("Missing required property \"{}\"", property)
+                        return report (
+                              { "/required/", nullptr, index }
+                            , fmt::format ("Missing required property \"{}\"", *property)
                         );
                     }
                     ++index;
                 }
             }
-            if (
-                  it = schema_object.find ("dependentRequired")
-                ; it != schema_object.end ()
-            ){
-                    auto&
-                sub_schema_object = it->second.get_object ();
+            if (schema.has (kw_dependent_required))
+            {
+                    keyword_probe_t
+                keyword_probe { context, kw_dependent_required };
                 for (auto&& [property, value]: instance_object)
                 {
                     if (
-                          auto&& array = sub_schema_object.find (property)
-                        ; array != sub_schema_object.end ()
+                          auto&& array = schema.dependent_required.find (property)
+                        ; array != schema.dependent_required.end ()
                     ){
-                        for (auto&& i: array->second.get_array ())
+                        for (auto&& dependent_property: array->second)
                         {
-                                auto&&
-                            dependent_property = i.get_string ();
                             if (instance_object.count (dependent_property) < 1)
                             {
-                                report (
-                                      "/dependentRequired"
+                                return report (
+                                      { "/dependentRequired" }
                                     , fmt::format ("Missing property \"{}\", required by the presence of \"{}\"", dependent_property, property)
                                 );
                             }
@@ -972,20 +4097,20 @@ private:
         {
                 auto&
             instance_array = instance.get_array ();
-            if (
-                  it = schema_object.find ("items")
-                ; it != schema_object.end ()
-            ){
-                    json_t::array_t
+            if (schema.has (kw_items))
+            {
+                    keyword_probe_t
+                keyword_probe { context, kw_items };
+                    std::vector <error_id_t>
                 sub_errors;
                     std::vector <std::size_t>
                 failures;
                     std::size_t
                 index = 0;
-                if (it->second.is_array ())
+                if (schema.items_is_array)
                 {
                         auto&
-                    schema_array = it->second.get_array ();
+                    schema_array = schema.items_array;
                     for (; 
                              index < instance_array.size () 
                           && index < schema_array.size ()
@@ -993,166 +4118,167 @@ private:
                     ){
                         if (
                                 auto&&
-                              [is_valid, e] = validate_impl (
+                              [is_valid, e] = descend (
                                   instance_array[index]
-                                , instance_location + fmt::format ("/{}", index)
-                                , schema_array[index]
-                                , schema_location + fmt::format ("/items/{}", index)
+                                , { "/", nullptr, index }
+                                , *schema_array[index]
+                                , { "/items/", nullptr, index }
+                                , sub_errors.size ()
                               )
                             ; !is_valid
                         ){
                             failures.push_back (index);
-                            sub_errors.push_back (std::move (e));
-                            //detail::concatenate (sub_errors, std::move (e));
+                            sub_errors.push_back (e);
                         }
                     }
                 }
+                else if (schema.numeric_items && instance_array.size () >= bulk_check_minimum)
+                {
+                    // The items the bulk check passes count as visited.
+                        std::size_t
+                    flagged = 0;
+                    check_numeric_items (instance_array, *schema.numeric_items, [&](std::size_t i)
+                    {
+                        ++flagged;
+                        if (
+                                auto&&
+                              [is_valid, e] = descend (
+                                  instance_array[i]
+                                , { "/", nullptr, i }
+                                , *schema.items
+                                , { "/items" }
+                                , sub_errors.size ()
+                              )
+                            ; !is_valid
+                        ){
+                            failures.push_back (i);
+                            sub_errors.push_back (e);
+                        }
+                        return true;
+                    });
+                    context.visited += instance_array.size () - flagged;
+                    index = instance_array.size ();
+                }
                 else
                 {
                     for (; index < instance_array.size (); ++index)
                     {
                         if (
                                 auto&&
-                              [is_valid, e] = validate_impl (
+                              [is_valid, e] = descend (
                                   instance_array[index]
-                                , instance_location + "/" + fmt::format ("{}", index)
-                                , it->second
-                                , schema_location + fmt::format ("/items")
+                                , { "/", nullptr, index }
+                                , *schema.items
+                                , { "/items" }
+                                , sub_errors.size ()
                               )
                             ; !is_valid
                         ){
                             failures.push_back (index);
-                            sub_errors.push_back (std::move (e));
-                            //detail::concatenate (sub_errors, std::move (e));
+                            sub_errors.push_back (e);
                         }
                     }
                 }
                 if (!failures.empty ())
                 {
-                    report (
-                          "/items"
+                    return report (
+                          { "/items" }
                         , fmt::format ("Not all dependent sub-schemas validate the instance: ", failures)
-                        , sub_errors
+                        , error_entry_t::array
+                        , std::move (sub_errors)
                     );
                 }
-                failures.clear ();
-                sub_errors.clear ();
-                if (
-                      it = schema_object.find ("additionalItems")
-                    ; it != schema_object.end ()
-                ){
+                if (schema.has (kw_additional_items))
+                {
                     for (; index < instance_array.size (); ++index)
                     {
                         if (
                                 auto&&
-                              [is_valid, e] = validate_impl (
+                              [is_valid, e] = descend (
                                   instance_array[index]
-                                , instance_location + "/" + fmt::format ("{}", index)
-                                , it->second
-                                , schema_location + fmt::format ("additionalItems")
+                                , { "/", nullptr, index }
+                                , *schema.additional_items
+                                , { "additionalItems" }
+                                , sub_errors.size ()
                               )
                             ; !is_valid
                         ){
                             failures.push_back (index);
-                            sub_errors.push_back (std::move (e));
-                            //detail::concatenate (sub_errors, std::move (e));
+                            sub_errors.push_back (e);
                         }
                     }
                     if (!failures.empty ())
                     {
-                        report (
-                              "/additionalItems"
+                        return report (
+                              { "/additionalItems" }
                             , fmt::format ("Not all dependent sub-schemas validate the instance: ", failures)
-                            , sub_errors
+                            , error_entry_t::array
+                            , std::move (sub_errors)
                         );
                     }
                 }
 
             }
-            if (
-                  it = schema_object.find ("contains")
-                ; it != schema_object.end ()
-            ){
+            if (schema.has (kw_contains))
+            {
+                    keyword_probe_t
+                keyword_probe { context, kw_contains };
                     std::size_t
                 contains_count = 0;
-                for (
-                      std::size_t index = 0 
-                    ; index < instance_array.size ()
-                    ; ++index
-                ){
-                    if (
-                            auto&&
-                          [is_valid, e] = validate_impl (
-                              instance_array[index]
-                            , instance_location + fmt::format ("/{}", index)
-                            , it->second
-                            , schema_location + fmt::format ("/items/{}", index)
-                          )
-                        ; is_valid
-                    ){
+                for (auto&& i: instance_array)
+                {
+                    if (is_valid_impl (i, *schema.contains, &context))
+                    {
                         ++contains_count;
                     }
                 }
                 if (contains_count == 0)
                 {
-                    report (
-                          "/contains"
+                    return report (
+                          { "/contains" }
                         , "No items of the instance validates the sub-schema"
                     );
                 }
-                if (
-                      it = schema_object.find ("maxContains")
-                    ; it != schema_object.end ()
-                ){
-                    if (contains_count > it->second.get_unsigned ())
+                if (schema.has (kw_max_contains))
+                {
+                    if (contains_count > schema.max_contains)
                     {
-                        report ("/maxContains", "Max contains exceeded");
+                        return report ({ "/maxContains" }, "Max contains exceeded");
                     }
                 }
-                if (
-                      it = schema_object.find ("minContains")
-                    ; it != schema_object.end ()
-                ){
-                    if (contains_count < it->second.get_unsigned ())
+                if (schema.has (kw_min_contains))
+                {
+                    if (contains_count < schema.min_contains)
                     {
-                        report ("/minContains", "Min contains subceeded");
+                        return report ({ "/minContains" }, "Min contains subceeded");
                     }
                 }
             }
-            if (
-                  it = schema_object.find ("maxItems")
-                ; it != schema_object.end ()
-            ){
-                if (instance_array.size () > it->second.get_unsigned ())
+            if (schema.has (kw_max_items))
+            {
+                    keyword_probe_t
+                keyword_probe { context, kw_max_items };
+                if (instance_array.size () > schema.max_items)
                 {
-                    report ("/maxItems", "Array has too many items");
+                    return report ({ "/maxItems" }, "Array has too many items");
                 }
             }
-            if (
-                  it = schema_object.find ("minItems")
-                ; it != schema_object.end ()
-            ){
-                if (instance_array.size () < it->second.get_unsigned ())
+            if (schema.has (kw_min_items))
+            {
+                    keyword_probe_t
+                keyword_probe { context, kw_min_items };
+                if (instance_array.size () < schema.min_items)
                 {
-                    report ("/minItems", "Array has too few items");
+                    return report ({ "/minItems" }, "Array has too few items");
                 }
             }
-            if (
-                  it = schema_object.find ("uniqueItems")
-                ; it != schema_object.end ()
-            ){
-                if (it->second.get_boolean ())
+            if (schema.has (kw_unique_items))
+            {
+                    keyword_probe_t
+                keyword_probe { context, kw_unique_items };
+                if (schema.unique_items && has_duplicates (instance_array))
                 {
-                        std::set <json_t>
-                    set;
-                    for (auto&& i: instance_array)
-                    {
-                        if (set.count (i) > 0)
-                        {
-                            report ("/uniqueItems", "Duplicate items found");
-                        }
-                        set.insert (i);
-                    }
+                    return report ({ "/uniqueItems" }, "Duplicate items found");
                 }
             }
 
@@ -1160,112 +4286,195 @@ private:
         // Instance is a number
         if (instance.is_number ())
         {
-            if (
-                  it = schema_object.find ("multipleOf")
-                ; it != schema_object.end ()
-            ){
-                if (remainder (instance.as <double> (), it->second.as <double> ()) != 0)
+            if (schema.has (kw_multiple_of))
+            {
+                    keyword_probe_t
+                keyword_probe { context, kw_multiple_of };
+                if (remainder (instance.as <double> (), schema.multiple_of) != 0)
                 {
-                    report ("multipleOf", "Failed");
+                    return report ({ "multipleOf" }, "Failed");
                 }
             }
-            if (
-                  it = schema_object.find ("maximum")
-                ; it != schema_object.end ()
-            ){
-                if (instance > it->second)
+            if (schema.has (kw_maximum))
+            {
+                    keyword_probe_t
+                keyword_probe { context, kw_maximum };
+                if (compare (instance, schema.maximum) > 0)
                 {
-                    report ("/maximum", "Maximum value exceeded");
+                    return report ({ "/maximum" }, "Maximum value exceeded");
                 }
             }
-            if (
-                  it = schema_object.find ("exclusiveMaximum")
-                ; it != schema_object.end ()
-            ){
-                if (instance >= it->second)
+            if (schema.has (kw_exclusive_maximum))
+            {
+                    keyword_probe_t
+                keyword_probe { context, kw_exclusive_maximum };
+                if (compare (instance, schema.exclusive_maximum) >= 0)
                 {
-                    report ("/exclusiveMaximum", "Exclusive maximum value exceeded");
+                    return report ({ "/exclusiveMaximum" }, "Exclusive maximum value exceeded");
                 }
             }
-            if (
-                  it = schema_object.find ("minimum")
-                ; it != schema_object.end ()
-            ){
-                if (instance < it->second)
+            if (schema.has (kw_minimum))
+            {
+                    keyword_probe_t
+                keyword_probe { context, kw_minimum };
+                if (compare (instance, schema.minimum) < 0)
                 {
-                    report ("/minimum", "Minimum value subceeded");
+                    return report ({ "/minimum" }, "Minimum value subceeded");
                 }
             }
-            if (
-                  it = schema_object.find ("exclusiveMinimum")
-                ; it != schema_object.end ()
-            ){
-                if (instance <= it->second)
+            if (schema.has (kw_exclusive_minimum))
+            {
+                    keyword_probe_t
+                keyword_probe { context, kw_exclusive_minimum };
+                if (compare (instance, schema.exclusive_minimum) <= 0)
                 {
-                    report ("/exclusiveMinimum", "Exclusive minimum value subceeded");
+                    return report ({ "/exclusiveMinimum" }, "Exclusive minimum value subceeded");
                 }
             }
         }
         // Instance is a string
         if (instance.is_string ())
         {
-            if (
-                  it = schema_object.find ("maxLength")
-                ; it != schema_object.end ()
-            ){
-                if (instance.get_string ().length () > it->second.get_unsigned ())
+            if (schema.has (kw_max_length))
+            {
+                    keyword_probe_t
+                keyword_probe { context, kw_max_length };
+                if (longer_than (instance.get_string (), schema.max_length))
                 {
-                    report ("/maxLength", "String too long");
+                    return report ({ "/maxLength" }, "String too long");
                 }
             }
-            if (
-                  it = schema_object.find ("minLength")
-                ; it != schema_object.end ()
-            ){
-                if (instance.get_string ().length () < it->second.get_unsigned ())
+            if (schema.has (kw_min_length))
+            {
+                    keyword_probe_t
+                keyword_probe { context, kw_min_length };
+                if (shorter_than (instance.get_string (), schema.min_length))
                 {
-                    report ("/minLength", "String too short");
+                    return report ({ "/minLength" }, "String too short");
                 }
             }
-            if (
-                  it = schema_object.find ("pattern")
-                ; it != schema_object.end ()
-            ){
-                    std::regex
-                re { it->second.get_string () };
-                if (!std::regex_search (instance.get_string (), re))
+            if (schema.has (kw_pattern))
+            {
+                    keyword_probe_t
+                keyword_probe { context, kw_pattern };
+                if (!std::regex_search (instance.get_string (), *schema.pattern_regex))
                 {
-                    report ("/pattern", "String does not match pattern");
+                    return report ({ "/pattern" }, "String does not match pattern");
                 }
             }
-            if (
-                  it = schema_object.find ("format")
-                ; it != schema_object.end ()
-            ){
-                // TODO
+            if (schema.has (kw_format))
+            {
+                    keyword_probe_t
+                keyword_probe { context, kw_format };
+                if (
+                       assert_formats_m
+                    && schema.format != formats::format_t::unknown
+                    && !formats::check (schema.format, instance.get_string ())
+                ){
+                    return report (
+                          { "/format" }
+                        , fmt::format ("String is not a valid \"{}\"", formats::format_name (schema.format))
+                    );
+                }
             }
-            if (
-                  it = schema_object.find ("contentEncoding")
-                ; it != schema_object.end ()
-            ){
+            if (schema.has (kw_content_encoding))
+            {
+                    keyword_probe_t
+                keyword_probe { context, kw_content_encoding };
                 // TODO
             }
-            if (
-                  it = schema_object.find ("contentMediaType")
-                ; it != schema_object.end ()
-            ){
+            if (schema.has (kw_content_media_type))
+            {
+                    keyword_probe_t
+                keyword_probe { context, kw_content_media_type };
                 // TODO
             }
         }
-        return { state, errors };
+        return { true, no_error };
+    }
+
+        auto
+    evaluate_impl (
+          const instance_t&                instance
+        , const detail::compiled_schema_t& schema
+        , detail::context_t&               context
+    ) const
+        -> validation_result_t
+    {
+        context.instance_path.clear ();
+        context.schema_path.clear ();
+        context.entries.clear ();
+        context.visited = 0;
+        context.unmemoized = 0;
+        context.memo.clear ();
+        context.outcomes.clear ();
+        context.suppressed = 0;
+            auto
+        [is_valid, e] = validate_impl (instance, schema, context);
+#ifdef CALCULISTO_JSON_VALIDATOR_PROFILE
+        ++context.profile.validations;
+        context.profile.nodes_visited += context.visited;
+#endif
+        // The context keeps its buffer for the next validation: a valid
+        // instance leaves no entry, the entries of an invalid one are moved
+        // out to a buffer of their own.
+            std::vector <detail::error_entry_t>
+        entries;
+        if (!is_valid)
+        {
+            entries.assign (
+                  std::make_move_iterator (std::begin (context.entries))
+                , std::make_move_iterator (std::end (context.entries))
+            );
+        }
+        return { is_valid, std::move (entries), e, context.visited, context.suppressed };
+    }
+
+        auto
+    find_schema (std::string const& schema_uri) const
+        -> const detail::compiled_schema_t&
+    {
+            auto
+        schema = last_schema_m;
+        if (!schema_uri.empty ())
+        {
+                std::tie
+            (schema, std::ignore) = resolve_reference (schema_uri);
+        }
+        if (schema)
+        {
+            return compiled (*schema);
+        }
+        throw std::runtime_error {"schema not found"};
     }
 
 // }}} private:
 public:
 
+    // The meta-schema is not parsed again: it is shared.
     validator_t ()
+        : meta_m        { &meta_validator () }
+        , last_schema_m { meta_m->meta_schema_m }
+        , meta_schema_m { meta_m->meta_schema_m }
+    {}
+
+    // The registered schemas and compiled nodes point into each other.
+    validator_t (validator_t const&) = delete;
+    validator_t (validator_t&&) = default;
+        validator_t&
+    operator = (validator_t const&) = delete;
+        validator_t&
+    operator = (validator_t&&) = default;
+
+    // When on, the strings are checked against the draft-07 formats (and
+    // "uuid") their "format" names: "date-time", "date", "time", "email",
+    // "hostname", "ipv4", "ipv6", "uri", "uri-reference", "json-pointer",
+    // "relative-json-pointer" and "regex". Other formats are not checked.
+    // Off by default, as the specification has it.
+        void
+    assert_formats (bool on) noexcept
     {
-        last_schema_m = add_meta_schema ();
+        assert_formats_m = on;
     }
 
         auto
@@ -1282,38 +4491,164 @@ public:
 
         [[nodiscard]]
         auto
-    validate (const instance_t& instance, std::string const& schema_uri = "")
+    validate (const instance_t& instance, std::string const& schema_uri = "") const
         -> std::pair <bool, json_t>
     {
             auto
-        schema = last_schema_m;
-        if (!schema_uri.empty ())
+        result = evaluate (instance, schema_uri);
+        return { result.valid (), result.errors () };
+    }
+
+        [[nodiscard]]
+        auto
+    validate (
+          const instance_t&           instance
+        , validation_options_t const& options
+        , std::string const&          schema_uri = ""
+    ) const
+        -> std::pair <bool, json_t>
+    {
+            auto
+        result = evaluate (instance, options, schema_uri);
+        return { result.valid (), result.errors () };
+    }
+
+    // Like validate (), but the errors are only rendered as JSON on demand,
+    // by validation_result_t::errors ().
+        [[nodiscard]]
+        auto
+    evaluate (const instance_t& instance, std::string const& schema_uri = "") const
+        -> validation_result_t
+    {
+            detail::context_t
+        context;
+        return evaluate_impl (instance, find_schema (schema_uri), context);
+    }
+
+        [[nodiscard]]
+        auto
+    evaluate (
+          const instance_t&           instance
+        , validation_options_t const& options
+        , std::string const&          schema_uri = ""
+    ) const
+        -> validation_result_t
+    {
+            detail::context_t
+        context;
+        context.max_errors = options.max_errors;
+        context.max_branch_errors = options.max_branch_errors;
+        return evaluate_impl (instance, find_schema (schema_uri), context);
+    }
+
+        [[nodiscard]]
+        auto
+    evaluate (
+          const instance_t&     instance
+        , validation_context_t& context
+        , std::string const&    schema_uri = ""
+    ) const
+        -> validation_result_t
+    {
+        return evaluate_impl (instance, find_schema (schema_uri), context.context_m);
+    }
+
+    // Only tells whether the instance is valid. Evaluation stops at the first
+    // failure and no error is built.
+        [[nodiscard]]
+        auto
+    is_valid (const instance_t& instance, std::string const& schema_uri = "") const
+        -> bool
+    {
+        return is_valid_impl (instance, find_schema (schema_uri));
+    }
+
+    // Validates the instances of [first, last) against the same schema, on a
+    // work-stealing thread pool. Instances are handed out in chunks, and each
+    // worker reuses a single validation context. The pool is shared by the
+    // process: its threads are started by the first batch that asks for that
+    // many, and the concurrent batches on it run one after the other.
+        template <std::random_access_iterator Iterator>
+        [[nodiscard]]
+        auto
+    validate_batch (
+          Iterator               first
+        , Iterator               last
+        , std::string const&     schema_uri = ""
+        , batch_options_t const& options = {}
+    ) const
+        -> batch_result_t
+    {
+            auto const&
+        schema = find_schema (schema_uri);
+            auto
+        count = static_cast <std::size_t> (std::distance (first, last));
+            auto&
+        pool = detail::shared_pool (options.threads);
+            auto
+        chunk_size = options.chunk_size
+            ? options.chunk_size
+            : std::max <std::size_t> (16, count / (pool.threads () * 16));
+            auto
+        chunks = (count + chunk_size - 1) / chunk_size;
+            batch_result_t
+        result;
+        result.valid.resize (count);
+            std::vector <std::vector <std::pair <std::size_t, json_t>>>
+        chunk_errors (options.collect_errors ? chunks : 0);
+            std::vector <detail::context_t>
+        contexts (pool.threads ());
+        pool.run (chunks, [&](std::size_t chunk, std::size_t worker)
         {
-                std::tie
-            (schema, std::ignore) = resolve_reference (schema_uri);
-        }
-        if (schema)
+                auto
+            end = std::min (count, (chunk + 1) * chunk_size);
+            for (auto i = chunk * chunk_size; i < end; ++i)
+            {
+                    const instance_t&
+                instance = first[i];
+                if (!options.collect_errors)
+                {
+                    result.valid[i] = is_valid_impl (instance, schema);
+                    continue;
+                }
+                    auto
+                r = evaluate_impl (instance, schema, contexts[worker]);
+                result.valid[i] = r.valid ();
+                if (!r.valid ())
+                {
+                    chunk_errors[chunk].emplace_back (i, r.errors ());
+                }
+            }
+        });
+        for (auto&& errors: chunk_errors)
         {
-            return validate_impl (
-                  instance
-                , "/"
-                , *schema
-                , "#"
+            std::move (
+                  std::begin (errors)
+                , std::end (errors)
+                , std::back_inserter (result.errors)
             );
         }
-        throw std::runtime_error {"schema not found"};
+        return result;
     }
 
         auto
-    validate_schema (const schema_t& schema)
+    validate_schema (const schema_t& schema) const
         -> std::pair <bool, json_t>
     {
-        return validate_impl (
-              schema
-            , "/"
-            , *meta_schema_m
-            , "#"
-        );
+            detail::context_t
+        context;
+            auto
+        result = evaluate_impl (schema, compiled (*meta_schema_m), context);
+        return { result.valid (), result.errors () };
+    }
+
+        auto
+    validate_schema (const schema_t& schema, validation_context_t& context) const
+        -> std::pair <bool, json_t>
+    {
+            auto
+        result = evaluate_impl (schema, compiled (*meta_schema_m), context.context_m);
+        return { result.valid (), result.errors () };
     }
 };
 
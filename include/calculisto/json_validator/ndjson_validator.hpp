@@ -0,0 +1,333 @@
+#pragma once
+#include "json_validator.hpp"
+
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+    namespace
+calculisto::json_validator
+{
+    struct
+ndjson_options_t
+{
+    // 0 means one thread per hardware thread.
+        std::size_t
+    threads = 0;
+    // The input is cut into chunks of about that many bytes, on line
+    // boundaries, as the workers ask for them. At most two chunks per thread
+    // are in flight.
+        std::size_t
+    chunk_bytes = 1 << 20;
+    // When false, only the line numbers of the failures are reported.
+        bool
+    collect_errors = true;
+};
+
+    struct
+ndjson_summary_t
+{
+    // Lines holding a document. Blank lines are skipped, but counted in the
+    // line numbers.
+        std::size_t
+    documents = 0;
+        std::size_t
+    invalid = 0;
+};
+
+// Validates newline delimited JSON (JSON Lines) against a registered schema:
+//
+//     ndjson_validator_t ndjson { validator, "http://example.com/record" };
+//     ndjson.validate_file ("export.ndjson", [](std::size_t line, json_t const& errors) { ... });
+//
+// Chunks of lines are parsed and validated in parallel, straight from the
+// input buffer (from a read-only memory mapping, for files). The sink is
+// called for each invalid line, in line order and one call at a time, from
+// one of the workers, with its 1-based line number and its errors (null when
+// collect_errors is false, or an object with a "message" when the line is
+// not JSON).
+    class
+ndjson_validator_t
+{
+private:
+        struct
+    failure_t
+    {
+            std::size_t
+        line;
+            json_t
+        errors;
+    };
+
+        struct
+    chunk_t
+    {
+            std::string_view
+        text;
+            std::size_t
+        lines = 0;
+            std::size_t
+        documents = 0;
+            std::vector <failure_t>
+        failures;
+            bool
+        done = false;
+    };
+
+        const validator_t&
+    validator_m;
+        const detail::compiled_schema_t&
+    schema_m;
+        ndjson_options_t
+    options_m;
+        detail::work_stealing_pool_t&
+    pool_m;
+
+        void
+    validate_chunk (chunk_t& chunk, detail::context_t& context) const
+    {
+            auto
+        text = chunk.text;
+        while (!text.empty ())
+        {
+                auto
+            end = text.find ('\n');
+                auto
+            line = text.substr (0, end);
+            text.remove_prefix (end == std::string_view::npos ? text.size () : end + 1);
+            ++chunk.lines;
+            if (!line.empty () && line.back () == '\r')
+            {
+                line.remove_suffix (1);
+            }
+            if (line.find_first_not_of (" \t") == std::string_view::npos)
+            {
+                continue;
+            }
+            ++chunk.documents;
+                instance_t
+            instance;
+            try
+            {
+                instance = tao::json::from_string (line);
+            }
+            catch (std::exception const& e)
+            {
+                chunk.failures.push_back ({ chunk.lines, json_t {
+                    { "message", fmt::format ("Parse error: {}", e.what ()) }
+                }});
+                continue;
+            }
+            if (!options_m.collect_errors)
+            {
+                if (!validator_m.is_valid_impl (instance, schema_m))
+                {
+                    chunk.failures.push_back ({ chunk.lines, tao::json::null });
+                }
+                continue;
+            }
+                auto
+            result = validator_m.evaluate_impl (instance, schema_m, context);
+            if (!result.valid ())
+            {
+                chunk.failures.push_back ({ chunk.lines, result.errors () });
+            }
+        }
+    }
+
+public:
+    // The validator must outlive this object.
+    ndjson_validator_t (
+          const validator_t&      validator
+        , std::string const&      schema_uri = ""
+        , ndjson_options_t const& options = {}
+    )
+        : validator_m { validator }
+        , schema_m    { validator.find_schema (schema_uri) }
+        , options_m   { options }
+        , pool_m      { detail::shared_pool (options.threads) }
+    {}
+
+        template <typename Sink>
+        auto
+    validate (std::string_view data, Sink&& sink) const
+        -> ndjson_summary_t
+    {
+            ndjson_summary_t
+        summary;
+            std::size_t
+        line = 0;
+            std::vector <detail::context_t>
+        contexts (pool_m.threads ());
+        // The chunks in flight, in input order: a worker cuts the next one as
+        // soon as it is done with its own, and task 0 hands the oldest ones
+        // to the sink once they are done.
+            std::deque <chunk_t>
+        chunks;
+            std::mutex
+        mutex;
+            std::condition_variable
+        changed;
+            bool
+        stopped = false;
+            auto
+        cut = [&]
+        {
+                auto
+            end = std::min (data.size (), options_m.chunk_bytes);
+            if (
+                    auto
+                  newline = data.find ('\n', end == 0 ? 0 : end - 1)
+                ; newline != std::string_view::npos
+            ){
+                end = newline + 1;
+            }
+            else
+            {
+                end = data.size ();
+            }
+                auto&
+            chunk = chunks.emplace_back ();
+            chunk.text = data.substr (0, end);
+            data.remove_prefix (end);
+            return &chunk;
+        };
+            auto
+        deliver = [&](std::unique_lock <std::mutex>& lock)
+        {
+            while (!chunks.empty () && chunks.front ().done)
+            {
+                    auto
+                chunk = std::move (chunks.front ());
+                chunks.pop_front ();
+                changed.notify_all ();
+                lock.unlock ();
+                for (auto&& failure: chunk.failures)
+                {
+                    sink (line + failure.line, std::as_const (failure.errors));
+                }
+                line += chunk.lines;
+                summary.documents += chunk.documents;
+                summary.invalid += chunk.failures.size ();
+                lock.lock ();
+            }
+        };
+        pool_m.run (pool_m.threads (), [&](std::size_t task, std::size_t worker)
+        {
+                std::unique_lock
+            lock { mutex };
+            try
+            {
+                for (;;)
+                {
+                    if (task == 0)
+                    {
+                        deliver (lock);
+                    }
+                    if (stopped || (data.empty () && (task != 0 || chunks.empty ())))
+                    {
+                        return;
+                    }
+                    if (data.empty () || chunks.size () >= 2 * pool_m.threads ())
+                    {
+                        // Task 0 waits for the oldest chunk, the others for
+                        // room.
+                        changed.wait (lock);
+                        continue;
+                    }
+                        auto
+                    chunk = cut ();
+                    lock.unlock ();
+                    validate_chunk (*chunk, contexts[worker]);
+                    lock.lock ();
+                    chunk->done = true;
+                    changed.notify_all ();
+                }
+            }
+            catch (...)
+            {
+                if (!lock)
+                {
+                    lock.lock ();
+                }
+                stopped = true;
+                changed.notify_all ();
+                throw;
+            }
+        });
+        return summary;
+    }
+
+    // The file is mapped read-only, and read sequentially.
+        template <typename Sink>
+        auto
+    validate_file (std::filesystem::path const& path, Sink&& sink) const
+        -> ndjson_summary_t
+    {
+            auto
+        fd = ::open (path.c_str (), O_RDONLY);
+        if (fd < 0)
+        {
+            throw (std::runtime_error { fmt::format (
+                  "Cannot open {}: {}."
+                , path.native ()
+                , std::strerror (errno)
+            )});
+        }
+            struct stat
+        st;
+        if (::fstat (fd, &st) != 0)
+        {
+            ::close (fd);
+            throw (std::runtime_error { fmt::format (
+                  "Cannot stat {}: {}."
+                , path.native ()
+                , std::strerror (errno)
+            )});
+        }
+            auto
+        size = static_cast <std::size_t> (st.st_size);
+        if (size == 0)
+        {
+            ::close (fd);
+            return {};
+        }
+            void*
+        address = ::mmap (nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close (fd);
+        if (address == MAP_FAILED)
+        {
+            throw (std::runtime_error { fmt::format (
+                  "Cannot map {}: {}."
+                , path.native ()
+                , std::strerror (errno)
+            )});
+        }
+        ::madvise (address, size, MADV_SEQUENTIAL);
+        try
+        {
+                auto
+            summary = validate (
+                  std::string_view { static_cast <const char*> (address), size }
+                , std::forward <Sink> (sink)
+            );
+            ::munmap (address, size);
+            return summary;
+        }
+        catch (...)
+        {
+            ::munmap (address, size);
+            throw;
+        }
+    }
+};
+
+} // namespace calculisto::json_validator
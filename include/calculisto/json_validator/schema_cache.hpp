@@ -0,0 +1,710 @@
+#pragma once
+#include "json_validator.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+    namespace
+calculisto::json_validator
+{
+    struct
+schema_file_t
+{
+        std::filesystem::path
+    path;
+    // The URI the document is registered under.
+        std::string
+    uri;
+};
+
+    namespace
+detail // {{{
+{
+    // A file, mapped read-only and shared: the processes that map the same
+    // cache share its pages.
+        class
+    mapped_file_t
+    {
+            void*
+        address_m = nullptr;
+            std::size_t
+        size_m = 0;
+
+    public:
+            explicit
+        mapped_file_t (std::filesystem::path const& path)
+        {
+                auto
+            fd = ::open (path.c_str (), O_RDONLY);
+            if (fd < 0)
+            {
+                throw (std::runtime_error { fmt::format (
+                      "Cannot open {}: {}."
+                    , path.native ()
+                    , std::strerror (errno)
+                )});
+            }
+                struct stat
+            st;
+            if (::fstat (fd, &st) != 0)
+            {
+                ::close (fd);
+                throw (std::runtime_error { fmt::format (
+                      "Cannot stat {}: {}."
+                    , path.native ()
+                    , std::strerror (errno)
+                )});
+            }
+            size_m = static_cast <std::size_t> (st.st_size);
+            if (size_m == 0)
+            {
+                ::close (fd);
+                return;
+            }
+            address_m = ::mmap (nullptr, size_m, PROT_READ, MAP_SHARED, fd, 0);
+            ::close (fd);
+            if (address_m == MAP_FAILED)
+            {
+                address_m = nullptr;
+                throw (std::runtime_error { fmt::format (
+                      "Cannot map {}: {}."
+                    , path.native ()
+                    , std::strerror (errno)
+                )});
+            }
+        }
+
+        mapped_file_t (mapped_file_t const&) = delete;
+            mapped_file_t&
+        operator = (mapped_file_t const&) = delete;
+
+        ~mapped_file_t ()
+        {
+            if (address_m)
+            {
+                ::munmap (address_m, size_m);
+            }
+        }
+
+            auto
+        text () const noexcept
+            -> std::string_view
+        {
+            return { static_cast <const char*> (address_m), size_m };
+        }
+    };
+
+    // The nodes of a document, in pre-order. A node of the cache is the
+    // index of its document and its rank in that order: 0 is the
+    // meta-schema, the documents of the validator follow.
+        inline void
+    number_nodes (json_t const& value, std::vector <const json_t*>& nodes)
+    {
+        nodes.push_back (&value);
+        if (value.is_array ())
+        {
+            for (auto&& i: value.get_array ())
+            {
+                number_nodes (i, nodes);
+            }
+        }
+        if (value.is_object ())
+        {
+            for (auto&& [key, member]: value.get_object ())
+            {
+                number_nodes (member, nodes);
+            }
+        }
+    }
+
+        struct
+    node_ref_t
+    {
+            std::uint32_t
+        document;
+            std::uint32_t
+        rank;
+    };
+
+        class
+    cache_writer_t
+    {
+            std::string
+        buffer_m;
+
+    public:
+            template <typename T>
+            void
+        put (T value)
+        {
+            static_assert (std::is_trivially_copyable_v <T>);
+                char
+            bytes[sizeof (T)];
+            std::memcpy (bytes, &value, sizeof (T));
+            buffer_m.append (bytes, sizeof (T));
+        }
+
+            void
+        put (std::string_view s)
+        {
+            put <std::uint64_t> (s.size ());
+            buffer_m.append (s);
+        }
+
+            void
+        put (json_t const& value)
+        {
+            switch (value.type ())
+            {
+                case tao::json::type::NULL_:
+                    put <std::uint8_t> (0);
+                    return;
+                case tao::json::type::BOOLEAN:
+                    put <std::uint8_t> (value.get_boolean () ? 2 : 1);
+                    return;
+                case tao::json::type::SIGNED:
+                    put <std::uint8_t> (3);
+                    put <std::int64_t> (value.get_signed ());
+                    return;
+                case tao::json::type::UNSIGNED:
+                    put <std::uint8_t> (4);
+                    put <std::uint64_t> (value.get_unsigned ());
+                    return;
+                case tao::json::type::DOUBLE:
+                    put <std::uint8_t> (5);
+                    put <double> (value.get_double ());
+                    return;
+                case tao::json::type::STRING:
+                case tao::json::type::STRING_VIEW:
+                    put <std::uint8_t> (6);
+                    put (value.get_string_type ());
+                    return;
+                case tao::json::type::ARRAY:
+                    put <std::uint8_t> (7);
+                    put <std::uint64_t> (value.get_array ().size ());
+                    for (auto&& i: value.get_array ())
+                    {
+                        put (i);
+                    }
+                    return;
+                case tao::json::type::OBJECT:
+                    put <std::uint8_t> (8);
+                    put <std::uint64_t> (value.get_object ().size ());
+                    for (auto&& [key, member]: value.get_object ())
+                    {
+                        put (std::string_view { key });
+                        put (member);
+                    }
+                    return;
+                default:
+                    throw (std::runtime_error { fmt::format (
+                          "{}:{}: Cannot cache a value of type {}."
+                        , __FILE__
+                        , __LINE__
+                        , tao::json::to_string (value.type ())
+                    )});
+            }
+        }
+
+            auto
+        buffer () const noexcept
+            -> std::string const&
+        {
+            return buffer_m;
+        }
+    };
+
+    // Reads what cache_writer_t wrote. A truncated or otherwise
+    // inconsistent cache throws.
+        class
+    cache_reader_t
+    {
+            std::string_view
+        data_m;
+
+            void
+        require (std::size_t size) const
+        {
+            if (data_m.size () < size)
+            {
+                throw (std::runtime_error { "Truncated schema cache." });
+            }
+        }
+
+    public:
+            explicit
+        cache_reader_t (std::string_view data) noexcept
+            : data_m { data }
+        {}
+
+            template <typename T>
+            auto
+        get ()
+            -> T
+        {
+            require (sizeof (T));
+                T
+            value;
+            std::memcpy (&value, data_m.data (), sizeof (T));
+            data_m.remove_prefix (sizeof (T));
+            return value;
+        }
+
+            auto
+        get_string ()
+            -> std::string_view
+        {
+                auto
+            size = get <std::uint64_t> ();
+            require (size);
+                auto
+            s = data_m.substr (0, size);
+            data_m.remove_prefix (size);
+            return s;
+        }
+
+            auto
+        get_value ()
+            -> json_t
+        {
+            switch (get <std::uint8_t> ())
+            {
+                case 0: return json_t { tao::json::null };
+                case 1: return json_t { false };
+                case 2: return json_t { true };
+                case 3: return json_t { get <std::int64_t> () };
+                case 4: return json_t { get <std::uint64_t> () };
+                case 5: return json_t { get <double> () };
+                case 6: return json_t { std::string { get_string () } };
+                case 7:
+                {
+                        auto
+                    size = get <std::uint64_t> ();
+                    // Each item takes at least one byte.
+                    require (size);
+                        json_t::array_t
+                    array;
+                    array.reserve (size);
+                    for (std::uint64_t i = 0; i < size; ++i)
+                    {
+                        array.push_back (get_value ());
+                    }
+                    return json_t { std::move (array) };
+                }
+                case 8:
+                {
+                        auto
+                    size = get <std::uint64_t> ();
+                        json_t::object_t
+                    object;
+                    for (std::uint64_t i = 0; i < size; ++i)
+                    {
+                            std::string
+                        key { get_string () };
+                        object.emplace (std::move (key), get_value ());
+                    }
+                    return json_t { std::move (object) };
+                }
+            }
+            throw (std::runtime_error { "Invalid value in schema cache." });
+        }
+
+            auto
+        empty () const noexcept
+            -> bool
+        {
+            return data_m.empty ();
+        }
+    };
+} // }}} namespace detail
+
+// Saves what a validator registered, and restores it in another process:
+//
+//     validator_t validator;
+//     schema_cache_t::add_schema_files (validator, files, "schemas.cache");
+//
+// The cache holds the documents, in a binary form, with the URIs, the
+// resolved references, the analysed and the shared sub-schemas. A validator
+// restored from it neither parses JSON text nor resolves a reference: it only
+// compiles, which takes the regular expressions, that cannot be stored. The
+// cache is mapped read-only and shared, and it is versioned and keyed by the
+// content of the source files: a stale cache is ignored and rewritten. It is
+// written to a temporary file, then renamed over the old one, so that a
+// process never reads it half written. It is only valid for the build that
+// wrote it.
+    class
+schema_cache_t
+{
+private:
+        static constexpr std::string_view
+    magic = "CJVCACHE";
+        static constexpr std::uint32_t
+    version = 1;
+        static constexpr std::uint32_t
+    byte_order = 0x01020304;
+
+        static auto
+    meta_schema (validator_t const& validator)
+        -> schema_t const&
+    {
+        return *(validator.meta_m ? validator.meta_m : &validator)->meta_schema_m;
+    }
+
+    // The documents the nodes of the cache refer to.
+        static auto
+    documents (validator_t const& validator)
+        -> std::vector <std::vector <const json_t*>>
+    {
+            std::vector <std::vector <const json_t*>>
+        documents (1 + validator.schemas_m.size ());
+        detail::number_nodes (meta_schema (validator), documents[0]);
+        for (std::size_t i = 0; i < validator.schemas_m.size (); ++i)
+        {
+            detail::number_nodes (validator.schemas_m[i], documents[i + 1]);
+        }
+        return documents;
+    }
+
+public:
+    // The key of the cache of these files.
+        static auto
+    key (std::vector <schema_file_t> const& files, std::vector <std::string_view> const& texts)
+        -> std::uint64_t
+    {
+            auto
+        h = detail::mix_hash (version);
+        for (std::size_t i = 0; i < files.size (); ++i)
+        {
+            h = detail::combine_item (h, std::hash <std::string_view> {} (files[i].uri));
+            h = detail::combine_item (h, std::hash <std::string_view> {} (texts[i]));
+        }
+        return h;
+    }
+
+        static void
+    save (validator_t const& validator, std::filesystem::path const& path, std::uint64_t key)
+    {
+            auto const
+        nodes = documents (validator);
+            std::unordered_map <const json_t*, detail::node_ref_t>
+        refs;
+        for (std::size_t d = 0; d < nodes.size (); ++d)
+        {
+            for (std::size_t r = 0; r < nodes[d].size (); ++r)
+            {
+                refs.emplace (nodes[d][r], detail::node_ref_t {
+                      static_cast <std::uint32_t> (d)
+                    , static_cast <std::uint32_t> (r)
+                });
+            }
+        }
+            detail::cache_writer_t
+        out;
+            auto
+        put_node = [&](const json_t* node)
+        {
+                auto
+            i = refs.find (node);
+            if (i == refs.end ())
+            {
+                throw (std::runtime_error { fmt::format (
+                      "{}:{}: A registered schema is outside of the documents."
+                    , __FILE__
+                    , __LINE__
+                )});
+            }
+            out.put (i->second);
+        };
+        for (auto c: magic)
+        {
+            out.put (c);
+        }
+        out.put (version);
+        out.put (byte_order);
+        out.put (key);
+        out.put (detail::hash_value (meta_schema (validator)));
+        out.put <std::uint64_t> (validator.schemas_m.size ());
+        for (auto&& document: validator.schemas_m)
+        {
+            out.put (detail::hash_value (document));
+            out.put (document);
+        }
+        out.put <std::uint64_t> (validator.registered_schemas_m.size ());
+        for (auto&& [uri, schema]: validator.registered_schemas_m)
+        {
+            out.put (std::string_view { uri });
+            put_node (schema);
+        }
+        out.put <std::uint64_t> (validator.registered_references_m.size ());
+        for (auto&& [reference, schema]: validator.registered_references_m)
+        {
+            put_node (reference);
+            put_node (schema);
+        }
+        // The compiled sub-schemas, in the order of their compilation.
+            std::vector <const schema_t*>
+        compiled;
+        for (auto&& node: validator.compiled_schemas_m)
+        {
+            compiled.push_back (node.schema);
+        }
+        out.put <std::uint64_t> (compiled.size ());
+        for (auto&& schema: compiled)
+        {
+            put_node (schema);
+        }
+        // Aliases are the indexed sub-schemas that were not compiled on
+        // their own.
+            std::vector <std::pair <const schema_t*, const schema_t*>>
+        aliases;
+        for (auto&& [schema, node]: validator.compiled_index_m)
+        {
+            if (node->schema != schema)
+            {
+                aliases.emplace_back (schema, node->schema);
+            }
+        }
+        out.put <std::uint64_t> (aliases.size ());
+        for (auto&& [alias, shared]: aliases)
+        {
+            put_node (alias);
+            put_node (shared);
+        }
+        out.put <std::uint64_t> (validator.shared_schemas_m.size ());
+        for (auto&& [hash, schema]: validator.shared_schemas_m)
+        {
+            out.put (hash);
+            put_node (schema);
+        }
+        put_node (validator.last_schema_m);
+            auto
+        temporary = path;
+        temporary += fmt::format (".{}.tmp", ::getpid ());
+        {
+                std::ofstream
+            file { temporary, std::ios::binary | std::ios::trunc };
+            file.write (out.buffer ().data (), static_cast <std::streamsize> (out.buffer ().size ()));
+            if (!file.flush ())
+            {
+                throw (std::runtime_error { fmt::format (
+                      "Cannot write {}."
+                    , temporary.native ()
+                )});
+            }
+        }
+        std::filesystem::rename (temporary, path);
+    }
+
+    // Restores the registrations saved under that key into a validator that
+    // registered nothing yet. Tells whether it did: a missing, stale or
+    // damaged cache leaves the validator as it was.
+        static auto
+    load (validator_t& validator, std::filesystem::path const& path, std::uint64_t key)
+        -> bool
+    {
+        if (!validator.schemas_m.empty ())
+        {
+            throw (std::runtime_error { fmt::format (
+                  "{}:{}: A schema cache can only be loaded into an empty validator."
+                , __FILE__
+                , __LINE__
+            )});
+        }
+            std::error_code
+        error;
+        if (!std::filesystem::is_regular_file (path, error))
+        {
+            return false;
+        }
+            detail::mapped_file_t
+        file { path };
+            detail::cache_reader_t
+        in { file.text () };
+            std::vector <std::pair <std::uint64_t, json_t>>
+        schemas;
+            std::vector <std::pair <std::string, detail::node_ref_t>>
+        uris;
+            std::vector <std::pair <detail::node_ref_t, detail::node_ref_t>>
+        references;
+            std::vector <detail::node_ref_t>
+        compiled;
+            std::vector <std::pair <detail::node_ref_t, detail::node_ref_t>>
+        aliases;
+            std::vector <std::pair <std::uint64_t, detail::node_ref_t>>
+        shared;
+            detail::node_ref_t
+        last;
+        try
+        {
+            for (auto c: magic)
+            {
+                if (in.get <char> () != c)
+                {
+                    return false;
+                }
+            }
+            if (
+                   in.get <std::uint32_t> () != version
+                || in.get <std::uint32_t> () != byte_order
+                || in.get <std::uint64_t> () != key
+                || in.get <std::uint64_t> () != detail::hash_value (meta_schema (validator))
+            ){
+                return false;
+            }
+            for (auto n = in.get <std::uint64_t> (); n > 0; --n)
+            {
+                    auto
+                hash = in.get <std::uint64_t> ();
+                schemas.emplace_back (hash, in.get_value ());
+            }
+            for (auto n = in.get <std::uint64_t> (); n > 0; --n)
+            {
+                    std::string
+                uri { in.get_string () };
+                uris.emplace_back (std::move (uri), in.get <detail::node_ref_t> ());
+            }
+            for (auto n = in.get <std::uint64_t> (); n > 0; --n)
+            {
+                    auto
+                reference = in.get <detail::node_ref_t> ();
+                references.emplace_back (reference, in.get <detail::node_ref_t> ());
+            }
+            for (auto n = in.get <std::uint64_t> (); n > 0; --n)
+            {
+                compiled.push_back (in.get <detail::node_ref_t> ());
+            }
+            for (auto n = in.get <std::uint64_t> (); n > 0; --n)
+            {
+                    auto
+                alias = in.get <detail::node_ref_t> ();
+                aliases.emplace_back (alias, in.get <detail::node_ref_t> ());
+            }
+            for (auto n = in.get <std::uint64_t> (); n > 0; --n)
+            {
+                    auto
+                hash = in.get <std::uint64_t> ();
+                shared.emplace_back (hash, in.get <detail::node_ref_t> ());
+            }
+            last = in.get <detail::node_ref_t> ();
+            if (!in.empty ())
+            {
+                return false;
+            }
+        }
+        catch (std::runtime_error const&)
+        {
+            return false;
+        }
+        // Check the nodes before touching the validator.
+            std::vector <std::vector <const json_t*>>
+        nodes (1 + schemas.size ());
+        detail::number_nodes (meta_schema (validator), nodes[0]);
+        for (std::size_t i = 0; i < schemas.size (); ++i)
+        {
+            detail::number_nodes (schemas[i].second, nodes[i + 1]);
+        }
+            auto
+        valid = [&](detail::node_ref_t r)
+        {
+            return r.document < nodes.size () && r.rank < nodes[r.document].size ();
+        };
+            bool
+        consistent = valid (last);
+        for (auto&& [uri, r]: uris) consistent = consistent && valid (r);
+        for (auto&& [a, b]: references) consistent = consistent && valid (a) && valid (b);
+        for (auto&& r: compiled) consistent = consistent && valid (r);
+        for (auto&& [a, b]: aliases) consistent = consistent && valid (a) && valid (b);
+        for (auto&& [hash, r]: shared) consistent = consistent && valid (r);
+        if (!consistent)
+        {
+            return false;
+        }
+        // The documents move into the validator, their nodes with them.
+        for (std::size_t i = 0; i < schemas.size (); ++i)
+        {
+                auto&
+            document = validator.schemas_m.emplace_back (std::move (schemas[i].second));
+            validator.schema_hashes_m.emplace (schemas[i].first, &document);
+            nodes[i + 1].clear ();
+            detail::number_nodes (document, nodes[i + 1]);
+        }
+            auto
+        node = [&](detail::node_ref_t r)
+        {
+            return nodes[r.document][r.rank];
+        };
+        for (auto&& [uri, r]: uris)
+        {
+            validator.registered_schemas_m.emplace (std::move (uri), node (r));
+        }
+        for (auto&& [reference, schema]: references)
+        {
+            validator.registered_references_m.emplace (node (reference), node (schema));
+        }
+        for (auto&& r: compiled)
+        {
+            validator.pending_compilation_m.push_back (node (r));
+            if (node (r)->is_object ())
+            {
+                validator.analysed_schemas_m.insert (node (r));
+            }
+        }
+        for (auto&& [alias, schema]: aliases)
+        {
+            validator.aliases_m.emplace (node (alias), node (schema));
+        }
+        for (auto&& [hash, r]: shared)
+        {
+            validator.shared_schemas_m.emplace (hash, node (r));
+        }
+        validator.last_schema_m = node (last);
+        validator.compile_pending ();
+        return true;
+    }
+
+    // Registers the files, from the cache when it is up to date, and rewrites
+    // it otherwise. Tells whether the cache was used.
+        static auto
+    add_schema_files (
+          validator_t&                      validator
+        , std::vector <schema_file_t> const& files
+        , std::filesystem::path const&      cache
+    )
+        -> bool
+    {
+            std::vector <std::unique_ptr <detail::mapped_file_t>>
+        mapped;
+            std::vector <std::string_view>
+        texts;
+        for (auto&& file: files)
+        {
+            texts.push_back (mapped.emplace_back (
+                std::make_unique <detail::mapped_file_t> (file.path)
+            )->text ());
+        }
+            auto
+        k = key (files, texts);
+        if (load (validator, cache, k))
+        {
+            return true;
+        }
+        for (std::size_t i = 0; i < files.size (); ++i)
+        {
+            validator.add_schema (tao::json::from_string (texts[i]), files[i].uri);
+        }
+        save (validator, cache, k);
+        return false;
+    }
+};
+
+} // namespace calculisto::json_validator
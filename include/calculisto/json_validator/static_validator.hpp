@@ -0,0 +1,1523 @@
+#pragma once
+#include "json_validator.hpp"
+
+#include <algorithm>
+#include <array>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+    namespace
+calculisto::json_validator
+{
+    namespace
+detail // {{{
+{
+    // A string literal, as a template argument.
+        template <std::size_t N>
+        struct
+    fixed_string_t
+    {
+            char
+        data[N] {};
+
+            constexpr
+        fixed_string_t (const char (&s)[N]) noexcept
+        {
+            std::copy_n (s, N, data);
+        }
+
+            constexpr auto
+        view () const noexcept
+            -> std::string_view
+        {
+            return { data, N - 1 };
+        }
+    };
+
+    // Not constexpr: reaching it during constant evaluation makes the
+    // schema a compile error, whose diagnostic shows the message.
+        inline void
+    static_schema_error (const char* message)
+    {
+        throw (std::runtime_error { message });
+    }
+
+    // A value of a document parsed at compile time. Nodes are in pre-order:
+    // the children of a node follow it, up to its end.
+        struct
+    static_node_t
+    {
+            tao::json::type
+        type = tao::json::type::NULL_;
+            bool
+        boolean = false;
+            number_t
+        number;
+        // The value of a string, and the key of an object member, in the
+        // text of the document.
+            std::size_t
+        string_begin = 0;
+            std::size_t
+        string_size = 0;
+            std::size_t
+        key_begin = 0;
+            std::size_t
+        key_size = 0;
+            std::size_t
+        end = 0;
+    };
+
+        inline constexpr std::size_t
+    static_npos = static_cast <std::size_t> (-1);
+
+        class
+    static_parser_t
+    {
+            std::string_view
+        input_m;
+            std::size_t
+        position_m = 0;
+
+            constexpr void
+        whitespace () noexcept
+        {
+            while (
+                   position_m < input_m.size ()
+                && (input_m[position_m] == ' ' || input_m[position_m] == '\t' || input_m[position_m] == '\n' || input_m[position_m] == '\r')
+            ){
+                ++position_m;
+            }
+        }
+
+            constexpr auto
+        peek () const
+            -> char
+        {
+            if (position_m >= input_m.size ())
+            {
+                static_schema_error ("Unexpected end of the schema.");
+            }
+            return input_m[position_m];
+        }
+
+            constexpr void
+        expect (char c)
+        {
+            if (peek () != c)
+            {
+                static_schema_error ("Syntax error in the schema.");
+            }
+            ++position_m;
+        }
+
+            constexpr auto
+        hex4 ()
+            -> std::uint32_t
+        {
+                std::uint32_t
+            code = 0;
+            for (int i = 0; i < 4; ++i)
+            {
+                    auto
+                c = peek ();
+                ++position_m;
+                code <<= 4;
+                if (c >= '0' && c <= '9') code |= c - '0';
+                else if (c >= 'a' && c <= 'f') code |= c - 'a' + 10;
+                else if (c >= 'A' && c <= 'F') code |= c - 'A' + 10;
+                else static_schema_error ("Invalid \\u escape in the schema.");
+            }
+            return code;
+        }
+
+        // Appends the decoded string to the text, and tells where it is.
+            constexpr auto
+        string ()
+            -> std::pair <std::size_t, std::size_t>
+        {
+            expect ('"');
+                auto
+            begin = text.size ();
+            for (;;)
+            {
+                    auto
+                c = peek ();
+                ++position_m;
+                if (c == '"')
+                {
+                    break;
+                }
+                if (static_cast <unsigned char> (c) < 0x20)
+                {
+                    static_schema_error ("Control character in a string of the schema.");
+                }
+                if (c != '\\')
+                {
+                    text += c;
+                    continue;
+                }
+                    auto
+                e = peek ();
+                ++position_m;
+                switch (e)
+                {
+                    case '"':  text += '"';  break;
+                    case '\\': text += '\\'; break;
+                    case '/':  text += '/';  break;
+                    case 'b':  text += '\b'; break;
+                    case 'f':  text += '\f'; break;
+                    case 'n':  text += '\n'; break;
+                    case 'r':  text += '\r'; break;
+                    case 't':  text += '\t'; break;
+                    case 'u':
+                    {
+                            auto
+                        code = hex4 ();
+                        if (code >= 0xd800 && code < 0xdc00)
+                        {
+                            expect ('\\');
+                            expect ('u');
+                                auto
+                            low = hex4 ();
+                            if (low < 0xdc00 || low >= 0xe000)
+                            {
+                                static_schema_error ("Invalid surrogate pair in the schema.");
+                            }
+                            code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+                        }
+                        if (code < 0x80)
+                        {
+                            text += static_cast <char> (code);
+                        }
+                        else if (code < 0x800)
+                        {
+                            text += static_cast <char> (0xc0 | (code >> 6));
+                            text += static_cast <char> (0x80 | (code & 0x3f));
+                        }
+                        else if (code < 0x10000)
+                        {
+                            text += static_cast <char> (0xe0 | (code >> 12));
+                            text += static_cast <char> (0x80 | ((code >> 6) & 0x3f));
+                            text += static_cast <char> (0x80 | (code & 0x3f));
+                        }
+                        else
+                        {
+                            text += static_cast <char> (0xf0 | (code >> 18));
+                            text += static_cast <char> (0x80 | ((code >> 12) & 0x3f));
+                            text += static_cast <char> (0x80 | ((code >> 6) & 0x3f));
+                            text += static_cast <char> (0x80 | (code & 0x3f));
+                        }
+                        break;
+                    }
+                    default:
+                        static_schema_error ("Invalid escape in a string of the schema.");
+                }
+            }
+            return { begin, text.size () - begin };
+        }
+
+        // Integers that fit are integers, like tao::json's. Other numbers
+        // must be exactly representable by one multiplication or division
+        // of exact doubles, so that they are the double tao::json would
+        // read.
+            constexpr void
+        number (static_node_t& node)
+        {
+                bool
+            negative = false;
+            if (peek () == '-')
+            {
+                negative = true;
+                ++position_m;
+            }
+            if (peek () < '0' || peek () > '9')
+            {
+                static_schema_error ("Syntax error in the schema.");
+            }
+                std::uint64_t
+            mantissa = 0;
+                int
+            exponent = 0;
+                bool
+            integral = true;
+            // Zeros that do not fit in the mantissa only scale it.
+                auto
+            digit = [&](char c, bool fraction)
+            {
+                    auto
+                d = static_cast <std::uint64_t> (c - '0');
+                if (mantissa <= (std::numeric_limits <std::uint64_t>::max () - d) / 10)
+                {
+                    mantissa = mantissa * 10 + d;
+                    exponent -= fraction;
+                }
+                else if (d != 0)
+                {
+                    static_schema_error ("A number of the schema has too many digits to be read at compile time.");
+                }
+                else
+                {
+                    exponent += !fraction;
+                }
+            };
+            while (position_m < input_m.size () && input_m[position_m] >= '0' && input_m[position_m] <= '9')
+            {
+                digit (input_m[position_m++], false);
+            }
+            if (position_m < input_m.size () && input_m[position_m] == '.')
+            {
+                integral = false;
+                ++position_m;
+                if (peek () < '0' || peek () > '9')
+                {
+                    static_schema_error ("Syntax error in the schema.");
+                }
+                while (position_m < input_m.size () && input_m[position_m] >= '0' && input_m[position_m] <= '9')
+                {
+                    digit (input_m[position_m++], true);
+                }
+            }
+            if (position_m < input_m.size () && (input_m[position_m] == 'e' || input_m[position_m] == 'E'))
+            {
+                integral = false;
+                ++position_m;
+                    bool
+                negative_exponent = false;
+                if (peek () == '+' || peek () == '-')
+                {
+                    negative_exponent = peek () == '-';
+                    ++position_m;
+                }
+                if (peek () < '0' || peek () > '9')
+                {
+                    static_schema_error ("Syntax error in the schema.");
+                }
+                    int
+                e = 0;
+                while (position_m < input_m.size () && input_m[position_m] >= '0' && input_m[position_m] <= '9')
+                {
+                    e = std::min (e * 10 + (input_m[position_m++] - '0'), 10000);
+                }
+                exponent += negative_exponent ? -e : e;
+            }
+            if (integral && exponent == 0)
+            {
+                if (negative && mantissa <= std::uint64_t { 1 } << 63)
+                {
+                    node.type = tao::json::type::SIGNED;
+                    node.number.kind = node.type;
+                    node.number.signed_value = mantissa == std::uint64_t { 1 } << 63
+                        ? std::numeric_limits <std::int64_t>::min ()
+                        : -static_cast <std::int64_t> (mantissa);
+                    return;
+                }
+                if (!negative && mantissa <= static_cast <std::uint64_t> (std::numeric_limits <std::int64_t>::max ()))
+                {
+                    node.type = tao::json::type::SIGNED;
+                    node.number.kind = node.type;
+                    node.number.signed_value = static_cast <std::int64_t> (mantissa);
+                    return;
+                }
+                if (!negative)
+                {
+                    node.type = tao::json::type::UNSIGNED;
+                    node.number.kind = node.type;
+                    node.number.unsigned_value = mantissa;
+                    return;
+                }
+            }
+            if (mantissa > std::uint64_t { 1 } << 53 || exponent < -22 || exponent > 22)
+            {
+                static_schema_error ("A number of the schema cannot be read exactly at compile time.");
+            }
+                double
+            power = 1;
+            for (int i = 0; i < (exponent < 0 ? -exponent : exponent); ++i)
+            {
+                power *= 10;
+            }
+                auto
+            value = exponent < 0
+                ? static_cast <double> (mantissa) / power
+                : static_cast <double> (mantissa) * power;
+            node.type = tao::json::type::DOUBLE;
+            node.number.kind = node.type;
+            node.number.double_value = negative ? -value : value;
+        }
+
+            constexpr void
+        literal (std::string_view word)
+        {
+            if (input_m.substr (position_m, word.size ()) != word)
+            {
+                static_schema_error ("Syntax error in the schema.");
+            }
+            position_m += word.size ();
+        }
+
+            constexpr void
+        value ()
+        {
+                auto
+            index = nodes.size ();
+            nodes.emplace_back ();
+            whitespace ();
+            switch (peek ())
+            {
+                case '{':
+                {
+                    nodes[index].type = tao::json::type::OBJECT;
+                    ++position_m;
+                    whitespace ();
+                    if (peek () == '}')
+                    {
+                        ++position_m;
+                        break;
+                    }
+                    for (;;)
+                    {
+                        whitespace ();
+                            auto
+                        [key_begin, key_size] = string ();
+                        whitespace ();
+                        expect (':');
+                            auto
+                        member = nodes.size ();
+                        value ();
+                        nodes[member].key_begin = key_begin;
+                        nodes[member].key_size = key_size;
+                        whitespace ();
+                        if (peek () == ',')
+                        {
+                            ++position_m;
+                            continue;
+                        }
+                        expect ('}');
+                        break;
+                    }
+                    break;
+                }
+                case '[':
+                {
+                    nodes[index].type = tao::json::type::ARRAY;
+                    ++position_m;
+                    whitespace ();
+                    if (peek () == ']')
+                    {
+                        ++position_m;
+                        break;
+                    }
+                    for (;;)
+                    {
+                        value ();
+                        whitespace ();
+                        if (peek () == ',')
+                        {
+                            ++position_m;
+                            continue;
+                        }
+                        expect (']');
+                        break;
+                    }
+                    break;
+                }
+                case '"':
+                {
+                    nodes[index].type = tao::json::type::STRING;
+                        auto
+                    [begin, size] = string ();
+                    nodes[index].string_begin = begin;
+                    nodes[index].string_size = size;
+                    break;
+                }
+                case 't':
+                    literal ("true");
+                    nodes[index].type = tao::json::type::BOOLEAN;
+                    nodes[index].boolean = true;
+                    break;
+                case 'f':
+                    literal ("false");
+                    nodes[index].type = tao::json::type::BOOLEAN;
+                    break;
+                case 'n':
+                    literal ("null");
+                    break;
+                default:
+                    number (nodes[index]);
+            }
+            nodes[index].end = nodes.size ();
+        }
+
+    public:
+            std::vector <static_node_t>
+        nodes;
+            std::string
+        text;
+
+            constexpr explicit
+        static_parser_t (std::string_view input)
+            : input_m { input }
+        {
+            value ();
+            whitespace ();
+            if (position_m != input_m.size ())
+            {
+                static_schema_error ("Trailing characters after the schema.");
+            }
+        }
+    };
+
+        template <std::size_t Nodes, std::size_t Text>
+        struct
+    static_document_t
+    {
+            std::array <static_node_t, Nodes>
+        nodes {};
+            std::array <char, Text + 1>
+        text {};
+
+            constexpr auto
+        string (std::size_t i) const
+            -> std::string_view
+        {
+            return { text.data () + nodes[i].string_begin, nodes[i].string_size };
+        }
+
+            constexpr auto
+        key (std::size_t i) const
+            -> std::string_view
+        {
+            return { text.data () + nodes[i].key_begin, nodes[i].key_size };
+        }
+
+            constexpr auto
+        children (std::size_t i) const
+            -> std::size_t
+        {
+                std::size_t
+            n = 0;
+            for (auto c = i + 1; c < nodes[i].end; c = nodes[c].end)
+            {
+                ++n;
+            }
+            return n;
+        }
+
+            constexpr auto
+        child (std::size_t i, std::size_t k) const
+            -> std::size_t
+        {
+                auto
+            c = i + 1;
+            for (; k > 0; --k)
+            {
+                c = nodes[c].end;
+            }
+            return c;
+        }
+
+        // The member of an object, or static_npos.
+            constexpr auto
+        member (std::size_t i, std::string_view name) const
+            -> std::size_t
+        {
+            if (nodes[i].type != tao::json::type::OBJECT)
+            {
+                return static_npos;
+            }
+            for (auto c = i + 1; c < nodes[i].end; c = nodes[c].end)
+            {
+                if (key (c) == name)
+                {
+                    return c;
+                }
+            }
+            return static_npos;
+        }
+
+        // The target of a "$ref", which must be a JSON pointer fragment.
+            constexpr auto
+        resolve (std::string_view reference) const
+            -> std::size_t
+        {
+            if (reference.empty () || reference[0] != '#')
+            {
+                static_schema_error ("Only the references to a JSON pointer in the schema are supported at compile time.");
+            }
+                std::string
+            pointer;
+            for (std::size_t j = 1; j < reference.size (); ++j)
+            {
+                if (reference[j] == '%' && j + 2 < reference.size ())
+                {
+                        auto
+                    hex = [](char c) { return c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10; };
+                    pointer += static_cast <char> (hex (reference[j + 1]) * 16 + hex (reference[j + 2]));
+                    j += 2;
+                    continue;
+                }
+                pointer += reference[j];
+            }
+                std::size_t
+            node = 0;
+                std::size_t
+            j = 0;
+            if (!pointer.empty () && pointer[0] != '/')
+            {
+                static_schema_error ("Only the references to a JSON pointer in the schema are supported at compile time.");
+            }
+            while (j < pointer.size ())
+            {
+                ++j;
+                    std::string
+                token;
+                for (; j < pointer.size () && pointer[j] != '/'; ++j)
+                {
+                    if (pointer[j] == '~' && j + 1 < pointer.size ())
+                    {
+                        token += pointer[j + 1] == '1' ? '/' : '~';
+                        ++j;
+                        continue;
+                    }
+                    token += pointer[j];
+                }
+                if (nodes[node].type == tao::json::type::OBJECT)
+                {
+                    node = member (node, token);
+                }
+                else if (nodes[node].type == tao::json::type::ARRAY)
+                {
+                        std::size_t
+                    index = 0;
+                    for (auto c: token)
+                    {
+                        if (c < '0' || c > '9')
+                        {
+                            static_schema_error ("Unresolvable reference in the schema.");
+                        }
+                        index = index * 10 + static_cast <std::size_t> (c - '0');
+                    }
+                    node = index < children (node) ? child (node, index) : static_npos;
+                }
+                else
+                {
+                    node = static_npos;
+                }
+                if (node == static_npos)
+                {
+                    static_schema_error ("Unresolvable reference in the schema.");
+                }
+            }
+            return node;
+        }
+
+            constexpr auto
+        is_schema (std::size_t i) const
+            -> bool
+        {
+            return nodes[i].type == tao::json::type::OBJECT
+                || nodes[i].type == tao::json::type::BOOLEAN;
+        }
+
+            constexpr auto
+        is_number (std::size_t i) const
+            -> bool
+        {
+            return nodes[i].type == tao::json::type::SIGNED
+                || nodes[i].type == tao::json::type::UNSIGNED
+                || nodes[i].type == tao::json::type::DOUBLE;
+        }
+
+            constexpr auto
+        count (std::size_t i) const
+            -> std::uint64_t
+        {
+            switch (nodes[i].type)
+            {
+                case tao::json::type::SIGNED:
+                    if (nodes[i].number.signed_value >= 0)
+                    {
+                        return static_cast <std::uint64_t> (nodes[i].number.signed_value);
+                    }
+                    break;
+                case tao::json::type::UNSIGNED:
+                    return nodes[i].number.unsigned_value;
+                case tao::json::type::DOUBLE:
+                    if (
+                           nodes[i].number.double_value >= 0
+                        && nodes[i].number.double_value == static_cast <double> (static_cast <std::uint64_t> (nodes[i].number.double_value))
+                    ){
+                        return static_cast <std::uint64_t> (nodes[i].number.double_value);
+                    }
+                    break;
+                default:
+                    break;
+            }
+            static_schema_error ("A keyword of the schema expects a non-negative integer.");
+            return 0;
+        }
+
+            constexpr auto
+        type_mask (std::size_t i) const
+            -> std::uint8_t
+        {
+                auto
+            mask_of = [&](std::size_t n) -> std::uint8_t
+            {
+                if (nodes[n].type != tao::json::type::STRING)
+                {
+                    static_schema_error ("\"type\" expects type names.");
+                }
+                    auto
+                name = string (n);
+                if (name == "null")    { return type_null;    }
+                if (name == "boolean") { return type_boolean; }
+                if (name == "object")  { return type_object;  }
+                if (name == "array")   { return type_array;   }
+                if (name == "number")  { return type_number;  }
+                if (name == "string")  { return type_string;  }
+                if (name == "integer") { return type_integer; }
+                static_schema_error ("Unknown type in the schema.");
+                return 0;
+            };
+            if (nodes[i].type != tao::json::type::ARRAY)
+            {
+                return mask_of (i);
+            }
+                std::uint8_t
+            mask = 0;
+            for (std::size_t k = 0; k < children (i); ++k)
+            {
+                mask |= mask_of (child (i, k));
+            }
+            return mask;
+        }
+
+        // Checks a sub-schema: the operands of the keywords, and that every
+        // keyword is supported. Each error is a compile error.
+            constexpr auto
+        check (std::size_t i, bool root = false) const
+            -> bool
+        {
+            if (nodes[i].type == tao::json::type::BOOLEAN)
+            {
+                return true;
+            }
+            if (nodes[i].type != tao::json::type::OBJECT)
+            {
+                static_schema_error ("A schema must be an object or a boolean.");
+            }
+                auto
+            schema = [&](std::size_t n)
+            {
+                if (!is_schema (n))
+                {
+                    static_schema_error ("A schema must be an object or a boolean.");
+                }
+                check (n);
+            };
+                auto
+            schemas = [&](std::size_t n, tao::json::type type)
+            {
+                if (nodes[n].type != type)
+                {
+                    static_schema_error ("A keyword of the schema expects an array or an object of schemas.");
+                }
+                for (std::size_t k = 0; k < children (n); ++k)
+                {
+                    schema (child (n, k));
+                }
+            };
+                auto
+            strings = [&](std::size_t n)
+            {
+                if (nodes[n].type != tao::json::type::ARRAY)
+                {
+                    static_schema_error ("A keyword of the schema expects an array of strings.");
+                }
+                for (std::size_t k = 0; k < children (n); ++k)
+                {
+                    if (nodes[child (n, k)].type != tao::json::type::STRING)
+                    {
+                        static_schema_error ("A keyword of the schema expects an array of strings.");
+                    }
+                }
+            };
+            for (auto c = i + 1; c < nodes[i].end; c = nodes[c].end)
+            {
+                    auto
+                name = key (c);
+                    auto
+                entry = find_keyword (name);
+                if (name == "$id" && !root)
+                {
+                    static_schema_error ("\"$id\" is only supported at the root of a schema, at compile time.");
+                }
+                switch (entry.keyword)
+                {
+                    case kw_ref:
+                        if (nodes[c].type != tao::json::type::STRING)
+                        {
+                            static_schema_error ("\"$ref\" expects a string.");
+                        }
+                        resolve (string (c));
+                        break;
+                    case kw_type:
+                        type_mask (c);
+                        break;
+                    case kw_enum:
+                        if (nodes[c].type != tao::json::type::ARRAY)
+                        {
+                            static_schema_error ("\"enum\" expects an array.");
+                        }
+                        break;
+                    case kw_required:
+                        strings (c);
+                        break;
+                    case kw_dependencies:
+                    case kw_dependent_required:
+                        if (nodes[c].type != tao::json::type::OBJECT)
+                        {
+                            static_schema_error ("A keyword of the schema expects an object.");
+                        }
+                        for (auto d = c + 1; d < nodes[c].end; d = nodes[d].end)
+                        {
+                            if (nodes[d].type == tao::json::type::ARRAY)
+                            {
+                                strings (d);
+                            }
+                            else if (entry.keyword == kw_dependencies)
+                            {
+                                schema (d);
+                            }
+                            else
+                            {
+                                strings (d);
+                            }
+                        }
+                        break;
+                    case kw_unique_items:
+                        if (nodes[c].type != tao::json::type::BOOLEAN)
+                        {
+                            static_schema_error ("\"uniqueItems\" expects a boolean.");
+                        }
+                        break;
+                    case kw_multiple_of:
+                        if (
+                               !is_number (c)
+                            || (nodes[c].type == tao::json::type::SIGNED && nodes[c].number.signed_value <= 0)
+                            || (nodes[c].type == tao::json::type::UNSIGNED && nodes[c].number.unsigned_value == 0)
+                            || (nodes[c].type == tao::json::type::DOUBLE && !(nodes[c].number.double_value > 0))
+                        ){
+                            static_schema_error ("\"multipleOf\" expects a positive number.");
+                        }
+                        break;
+                    case kw_maximum:
+                    case kw_exclusive_maximum:
+                    case kw_minimum:
+                    case kw_exclusive_minimum:
+                        if (!is_number (c))
+                        {
+                            static_schema_error ("A keyword of the schema expects a number.");
+                        }
+                        break;
+                    case kw_max_properties:
+                    case kw_min_properties:
+                    case kw_max_contains:
+                    case kw_min_contains:
+                    case kw_max_items:
+                    case kw_min_items:
+                    case kw_max_length:
+                    case kw_min_length:
+                        count (c);
+                        break;
+                    case kw_pattern:
+                    case kw_pattern_properties:
+                        static_schema_error ("Regular expressions are not supported at compile time.");
+                        break;
+                    case kw_items:
+                        if (nodes[c].type == tao::json::type::ARRAY)
+                        {
+                            schemas (c, tao::json::type::ARRAY);
+                        }
+                        else
+                        {
+                            schema (c);
+                        }
+                        break;
+                    default:
+                        switch (entry.kind)
+                        {
+                            case holds_schema:
+                                schema (c);
+                                break;
+                            case holds_array_of_schemas:
+                                schemas (c, tao::json::type::ARRAY);
+                                break;
+                            case holds_object_of_schemas:
+                                schemas (c, tao::json::type::OBJECT);
+                                break;
+                            default:
+                                break;
+                        }
+                }
+            }
+            return true;
+        }
+    };
+
+    // The parsed schema literal, sized by a first parse.
+        template <fixed_string_t Schema>
+        constexpr auto
+    make_static_document ()
+    {
+            constexpr auto
+        sizes = []
+        {
+                static_parser_t
+            parser { Schema.view () };
+            return std::pair { parser.nodes.size (), parser.text.size () };
+        } ();
+            static_parser_t
+        parser { Schema.view () };
+            static_document_t <sizes.first, sizes.second>
+        document;
+        std::copy (parser.nodes.begin (), parser.nodes.end (), document.nodes.begin ());
+        std::copy (parser.text.begin (), parser.text.end (), document.text.begin ());
+        return document;
+    }
+
+        template <fixed_string_t Schema>
+        inline constexpr auto
+    static_document = make_static_document <Schema> ();
+
+    // Calls f with the position and the node of each child of a node, as
+    // constants, while it returns true.
+        template <fixed_string_t Schema, std::size_t I, typename F>
+        inline bool
+    static_each_child (F&& f)
+    {
+        return [&] <std::size_t... K> (std::index_sequence <K...>)
+        {
+            return (f (
+                  std::integral_constant <std::size_t, K> {}
+                , std::integral_constant <std::size_t, static_document <Schema>.child (I, K)> {}
+            ) && ...);
+        } (std::make_index_sequence <static_document <Schema>.children (I)> {});
+    }
+
+    // The equality of json_t, with a constant.
+        template <fixed_string_t Schema, std::size_t I>
+        inline bool
+    static_equal (const json_t& instance)
+    {
+            constexpr auto const&
+        document = static_document <Schema>;
+            constexpr auto
+        type = document.nodes[I].type;
+        if constexpr (type == tao::json::type::NULL_)
+        {
+            return instance.is_null ();
+        }
+        else if constexpr (type == tao::json::type::BOOLEAN)
+        {
+            return instance.is_boolean () && instance.get_boolean () == document.nodes[I].boolean;
+        }
+        else if constexpr (type == tao::json::type::STRING)
+        {
+            return instance.is_string () && instance.get_string () == document.string (I);
+        }
+        else if constexpr (type == tao::json::type::ARRAY)
+        {
+            if (!instance.is_array () || instance.get_array ().size () != document.children (I))
+            {
+                return false;
+            }
+            return static_each_child <Schema, I> ([&](auto k, auto c)
+            {
+                return static_equal <Schema, c ()> (instance.get_array ()[k ()]);
+            });
+        }
+        else if constexpr (type == tao::json::type::OBJECT)
+        {
+            if (!instance.is_object () || instance.get_object ().size () != document.children (I))
+            {
+                return false;
+            }
+            return static_each_child <Schema, I> ([&](auto, auto c)
+            {
+                    constexpr auto
+                key = static_document <Schema>.key (c ());
+                    auto
+                i = instance.get_object ().find (key);
+                return i != instance.get_object ().end () && static_equal <Schema, c ()> (i->second);
+            });
+        }
+        else
+        {
+            return instance.is_number () && compare (instance, document.nodes[I].number) == 0;
+        }
+    }
+
+    // Whether all the names of an array of strings are properties.
+        template <fixed_string_t Schema, std::size_t I>
+        inline bool
+    static_has_all (const json_t::object_t& object)
+    {
+        return static_each_child <Schema, I> ([&](auto, auto c)
+        {
+            return object.find (static_document <Schema>.string (c ())) != object.end ();
+        });
+    }
+
+    // From that many members on, an "enum" of strings or of integers is
+    // looked up in a table sorted at compile time, rather than compared with
+    // each member.
+        inline constexpr std::size_t
+    static_enum_table_minimum = 8;
+
+    // STRING or SIGNED when all the members of an "enum" large enough for a
+    // table are, NULL_ otherwise.
+        template <fixed_string_t Schema, std::size_t I>
+        constexpr auto
+    static_enum_kind ()
+        -> tao::json::type
+    {
+            constexpr auto const&
+        document = static_document <Schema>;
+        if (document.children (I) < static_enum_table_minimum)
+        {
+            return tao::json::type::NULL_;
+        }
+            auto
+        kind = document.nodes[I + 1].type;
+        if (kind != tao::json::type::STRING && kind != tao::json::type::SIGNED)
+        {
+            return tao::json::type::NULL_;
+        }
+        for (auto c = I + 1; c < document.nodes[I].end; c = document.nodes[c].end)
+        {
+            if (document.nodes[c].type != kind)
+            {
+                return tao::json::type::NULL_;
+            }
+        }
+        return kind;
+    }
+
+    // The members of an "enum", as T (std::string_view or std::int64_t),
+    // sorted.
+        template <fixed_string_t Schema, std::size_t I, typename T>
+        constexpr auto
+    make_static_enum_table ()
+    {
+            constexpr auto const&
+        document = static_document <Schema>;
+            std::array <T, document.children (I)>
+        table {};
+            std::size_t
+        k = 0;
+        for (auto c = I + 1; c < document.nodes[I].end; c = document.nodes[c].end)
+        {
+            if constexpr (std::is_same_v <T, std::string_view>)
+            {
+                table[k++] = document.string (c);
+            }
+            else
+            {
+                table[k++] = document.nodes[c].number.signed_value;
+            }
+        }
+        std::sort (table.begin (), table.end ());
+        return table;
+    }
+
+        template <fixed_string_t Schema, std::size_t I, typename T>
+        inline constexpr auto
+    static_enum_table = make_static_enum_table <Schema, I, T> ();
+
+    // Whether an instance is one of the members of an "enum".
+        template <fixed_string_t Schema, std::size_t I>
+        inline bool
+    static_enum_contains (const json_t& instance)
+    {
+            constexpr auto
+        kind = static_enum_kind <Schema, I> ();
+        if constexpr (kind == tao::json::type::STRING)
+        {
+                auto const&
+            table = static_enum_table <Schema, I, std::string_view>;
+            return instance.is_string ()
+                && std::binary_search (table.begin (), table.end (), std::string_view { instance.get_string () });
+        }
+        else if constexpr (kind == tao::json::type::SIGNED)
+        {
+            if (!instance.is_number ())
+            {
+                return false;
+            }
+                auto const&
+            table = static_enum_table <Schema, I, std::int64_t>;
+            // compare () tells a double equal to an integer, as
+            // static_equal () does.
+                auto
+            number = [](std::int64_t v)
+            {
+                    number_t
+                n;
+                n.kind = tao::json::type::SIGNED;
+                n.signed_value = v;
+                return n;
+            };
+                auto
+            i = std::partition_point (table.begin (), table.end (), [&](std::int64_t v)
+            {
+                return compare (instance, number (v)) > 0;
+            });
+            return i != table.end () && compare (instance, number (*i)) == 0;
+        }
+        else
+        {
+            return !static_each_child <Schema, I> ([&](auto, auto c) { return !static_equal <Schema, c ()> (instance); });
+        }
+    }
+
+    // The checks of is_valid_impl (), in the same order, for a sub-schema
+    // known at compile time.
+        template <fixed_string_t Schema, std::size_t I>
+        inline bool
+    static_is_valid (const json_t& instance)
+    {
+            constexpr auto const&
+        document = static_document <Schema>;
+        if constexpr (document.nodes[I].type == tao::json::type::BOOLEAN)
+        {
+            return document.nodes[I].boolean;
+        }
+        else if constexpr (constexpr auto ref = document.member (I, "$ref"); ref != static_npos)
+        {
+            return static_is_valid <Schema, document.resolve (document.string (ref))> (instance);
+        }
+        else
+        {
+            if constexpr (constexpr auto k = document.member (I, "allOf"); k != static_npos)
+            {
+                if (!static_each_child <Schema, k> ([&](auto, auto c) { return static_is_valid <Schema, c ()> (instance); }))
+                {
+                    return false;
+                }
+            }
+            if constexpr (constexpr auto k = document.member (I, "anyOf"); k != static_npos)
+            {
+                if (static_each_child <Schema, k> ([&](auto, auto c) { return !static_is_valid <Schema, c ()> (instance); }))
+                {
+                    return false;
+                }
+            }
+            if constexpr (constexpr auto k = document.member (I, "oneOf"); k != static_npos)
+            {
+                    std::size_t
+                successes = 0;
+                static_each_child <Schema, k> ([&](auto, auto c)
+                {
+                    return !(static_is_valid <Schema, c ()> (instance) && ++successes > 1);
+                });
+                if (successes != 1)
+                {
+                    return false;
+                }
+            }
+            if constexpr (constexpr auto k = document.member (I, "not"); k != static_npos)
+            {
+                if (static_is_valid <Schema, k> (instance))
+                {
+                    return false;
+                }
+            }
+            if constexpr (constexpr auto k = document.member (I, "if"); k != static_npos)
+            {
+                    constexpr auto
+                then_schema = document.member (I, "then");
+                    constexpr auto
+                else_schema = document.member (I, "else");
+                if (static_is_valid <Schema, k> (instance))
+                {
+                    if constexpr (then_schema != static_npos)
+                    {
+                        if (!static_is_valid <Schema, then_schema> (instance))
+                        {
+                            return false;
+                        }
+                    }
+                }
+                else
+                {
+                    if constexpr (else_schema != static_npos)
+                    {
+                        if (!static_is_valid <Schema, else_schema> (instance))
+                        {
+                            return false;
+                        }
+                    }
+                }
+            }
+            if constexpr (constexpr auto k = document.member (I, "type"); k != static_npos)
+            {
+                if (!(type_mask (instance) & document.type_mask (k)))
+                {
+                    return false;
+                }
+            }
+            if constexpr (constexpr auto k = document.member (I, "enum"); k != static_npos)
+            {
+                if (!static_enum_contains <Schema, k> (instance))
+                {
+                    return false;
+                }
+            }
+            if constexpr (constexpr auto k = document.member (I, "const"); k != static_npos)
+            {
+                if (!static_equal <Schema, k> (instance))
+                {
+                    return false;
+                }
+            }
+            if (instance.is_object ())
+            {
+                    [[maybe_unused]] auto const&
+                object = instance.get_object ();
+                if constexpr (constexpr auto k = document.member (I, "dependencies"); k != static_npos)
+                {
+                    if (!static_each_child <Schema, k> ([&](auto, auto c)
+                    {
+                        if (object.find (static_document <Schema>.key (c ())) == object.end ())
+                        {
+                            return true;
+                        }
+                        if constexpr (static_document <Schema>.nodes[c ()].type == tao::json::type::ARRAY)
+                        {
+                            return static_has_all <Schema, c ()> (object);
+                        }
+                        else
+                        {
+                            return static_is_valid <Schema, c ()> (instance);
+                        }
+                    })){
+                        return false;
+                    }
+                }
+                if constexpr (constexpr auto k = document.member (I, "dependentSchemas"); k != static_npos)
+                {
+                    if (!static_each_child <Schema, k> ([&](auto, auto c)
+                    {
+                        return object.find (static_document <Schema>.key (c ())) == object.end ()
+                            || static_is_valid <Schema, c ()> (instance);
+                    })){
+                        return false;
+                    }
+                }
+                if constexpr (constexpr auto k = document.member (I, "maxProperties"); k != static_npos)
+                {
+                    if (object.size () > document.count (k))
+                    {
+                        return false;
+                    }
+                }
+                if constexpr (constexpr auto k = document.member (I, "minProperties"); k != static_npos)
+                {
+                    if (object.size () < document.count (k))
+                    {
+                        return false;
+                    }
+                }
+                if constexpr (constexpr auto k = document.member (I, "required"); k != static_npos)
+                {
+                    if (!static_has_all <Schema, k> (object))
+                    {
+                        return false;
+                    }
+                }
+                if constexpr (constexpr auto k = document.member (I, "dependentRequired"); k != static_npos)
+                {
+                    if (!static_each_child <Schema, k> ([&](auto, auto c)
+                    {
+                        return object.find (static_document <Schema>.key (c ())) == object.end ()
+                            || static_has_all <Schema, c ()> (object);
+                    })){
+                        return false;
+                    }
+                }
+                    constexpr auto
+                properties = document.member (I, "properties");
+                    constexpr auto
+                additional_properties = document.member (I, "additionalProperties");
+                    constexpr auto
+                property_names = document.member (I, "propertyNames");
+                if constexpr (
+                       properties != static_npos
+                    || additional_properties != static_npos
+                    || property_names != static_npos
+                ){
+                    for (auto&& [property, value]: object)
+                    {
+                            [[maybe_unused]] bool
+                        apply_additional = true;
+                        if constexpr (properties != static_npos)
+                        {
+                                bool
+                            valid = true;
+                            static_each_child <Schema, properties> ([&](auto, auto c)
+                            {
+                                if (property != static_document <Schema>.key (c ()))
+                                {
+                                    return true;
+                                }
+                                apply_additional = false;
+                                valid = static_is_valid <Schema, c ()> (value);
+                                return false;
+                            });
+                            if (!valid)
+                            {
+                                return false;
+                            }
+                        }
+                        if constexpr (additional_properties != static_npos)
+                        {
+                            if (apply_additional && !static_is_valid <Schema, additional_properties> (value))
+                            {
+                                return false;
+                            }
+                        }
+                        if constexpr (property_names != static_npos)
+                        {
+                            if (!static_is_valid <Schema, property_names> (json_t { property }))
+                            {
+                                return false;
+                            }
+                        }
+                    }
+                }
+            }
+            if (instance.is_array ())
+            {
+                    [[maybe_unused]] auto const&
+                array = instance.get_array ();
+                if constexpr (constexpr auto k = document.member (I, "maxItems"); k != static_npos)
+                {
+                    if (array.size () > document.count (k))
+                    {
+                        return false;
+                    }
+                }
+                if constexpr (constexpr auto k = document.member (I, "minItems"); k != static_npos)
+                {
+                    if (array.size () < document.count (k))
+                    {
+                        return false;
+                    }
+                }
+                if constexpr (constexpr auto k = document.member (I, "items"); k != static_npos)
+                {
+                        std::size_t
+                    index = 0;
+                    if constexpr (document.nodes[k].type == tao::json::type::ARRAY)
+                    {
+                        if (!static_each_child <Schema, k> ([&](auto position, auto c)
+                        {
+                            return position () >= array.size () || static_is_valid <Schema, c ()> (array[position ()]);
+                        })){
+                            return false;
+                        }
+                        index = std::min (array.size (), document.children (k));
+                    }
+                    else
+                    {
+                        for (; index < array.size (); ++index)
+                        {
+                            if (!static_is_valid <Schema, k> (array[index]))
+                            {
+                                return false;
+                            }
+                        }
+                    }
+                    if constexpr (constexpr auto a = document.member (I, "additionalItems"); a != static_npos)
+                    {
+                        for (; index < array.size (); ++index)
+                        {
+                            if (!static_is_valid <Schema, a> (array[index]))
+                            {
+                                return false;
+                            }
+                        }
+                    }
+                }
+                if constexpr (constexpr auto k = document.member (I, "contains"); k != static_npos)
+                {
+                        std::size_t
+                    count = 0;
+                    for (auto&& i: array)
+                    {
+                        count += static_is_valid <Schema, k> (i);
+                    }
+                    if (count == 0)
+                    {
+                        return false;
+                    }
+                    if constexpr (constexpr auto m = document.member (I, "maxContains"); m != static_npos)
+                    {
+                        if (count > document.count (m))
+                        {
+                            return false;
+                        }
+                    }
+                    if constexpr (constexpr auto m = document.member (I, "minContains"); m != static_npos)
+                    {
+                        if (count < document.count (m))
+                        {
+                            return false;
+                        }
+                    }
+                }
+                if constexpr (constexpr auto k = document.member (I, "uniqueItems"); k != static_npos)
+                {
+                    if constexpr (document.nodes[k].boolean)
+                    {
+                        if (has_duplicates (array))
+                        {
+                            return false;
+                        }
+                    }
+                }
+            }
+            if (instance.is_number ())
+            {
+                if constexpr (constexpr auto k = document.member (I, "multipleOf"); k != static_npos)
+                {
+                        constexpr auto
+                    n = document.nodes[k].number;
+                        constexpr double
+                    divisor = n.kind == tao::json::type::SIGNED
+                        ? static_cast <double> (n.signed_value)
+                        : n.kind == tao::json::type::UNSIGNED
+                            ? static_cast <double> (n.unsigned_value)
+                            : n.double_value;
+                    if (std::remainder (instance.as <double> (), divisor) != 0)
+                    {
+                        return false;
+                    }
+                }
+                if constexpr (constexpr auto k = document.member (I, "maximum"); k != static_npos)
+                {
+                    if (compare (instance, document.nodes[k].number) > 0)
+                    {
+                        return false;
+                    }
+                }
+                if constexpr (constexpr auto k = document.member (I, "exclusiveMaximum"); k != static_npos)
+                {
+                    if (compare (instance, document.nodes[k].number) >= 0)
+                    {
+                        return false;
+                    }
+                }
+                if constexpr (constexpr auto k = document.member (I, "minimum"); k != static_npos)
+                {
+                    if (compare (instance, document.nodes[k].number) < 0)
+                    {
+                        return false;
+                    }
+                }
+                if constexpr (constexpr auto k = document.member (I, "exclusiveMinimum"); k != static_npos)
+                {
+                    if (compare (instance, document.nodes[k].number) <= 0)
+                    {
+                        return false;
+                    }
+                }
+            }
+            if (instance.is_string ())
+            {
+                if constexpr (constexpr auto k = document.member (I, "maxLength"); k != static_npos)
+                {
+                    if (detail::longer_than (instance.get_string (), document.count (k)))
+                    {
+                        return false;
+                    }
+                }
+                if constexpr (constexpr auto k = document.member (I, "minLength"); k != static_npos)
+                {
+                    if (detail::shorter_than (instance.get_string (), document.count (k)))
+                    {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+    }
+} // }}} namespace detail
+
+// A schema known at compile time:
+//
+//     using order_validator = static_validator_t <R"({
+//         "type": "object", "required": [ "id" ], ...
+//     })">;
+//     order_validator::is_valid (instance);
+//
+// The schema is parsed and checked during compilation: a malformed schema,
+// or one that uses a keyword that cannot be compiled, is a compile error.
+// Each sub-schema becomes an instantiation of a function template whose
+// keywords are resolved with "if constexpr", "$ref" included, so that
+// validating runs inlined checks, with no registry and no allocation, but
+// for "propertyNames" and "uniqueItems". Regular expressions ("pattern",
+// "patternProperties") are not supported, nor "$ref" outside of the schema,
+// nor "$id" below its root. Numbers of the schema are read exactly, or not
+// at all. "format" is an annotation: it is never asserted, whatever
+// validator_t::assert_formats () says. A large "enum" of strings or of
+// integers is a binary search in a table sorted during compilation.
+//
+// validate () builds the errors of an invalid instance with a validator_t
+// that holds the schema, built on the first invalid instance, so that they
+// have the shape of validator_t::validate ()'s.
+    template <detail::fixed_string_t Schema>
+    class
+static_validator_t
+{
+    static_assert (detail::static_document <Schema>.check (0, true));
+
+public:
+        [[nodiscard]]
+        static auto
+    is_valid (const instance_t& instance)
+        -> bool
+    {
+        return detail::static_is_valid <Schema, 0> (instance);
+    }
+
+        [[nodiscard]]
+        static auto
+    validate (const instance_t& instance)
+        -> std::pair <bool, json_t>
+    {
+        if (is_valid (instance))
+        {
+            return { true, tao::json::null };
+        }
+            static const validator_t
+        validator = []
+        {
+                validator_t
+            v;
+            v.add_schema (
+                  tao::json::from_string (Schema.view ())
+                , "http://localhost/static_validator"
+            );
+            return v;
+        } ();
+        return validator.validate (instance);
+    }
+};
+
+} // namespace calculisto::json_validator
@@ -0,0 +1,565 @@
+#pragma once
+#include "json_validator.hpp"
+
+#include <optional>
+
+    namespace
+calculisto::json_validator
+{
+// A tao::json events consumer that validates a document while it is parsed,
+// without building it:
+//
+//     stream_validator_t consumer { validator, "http://example.com/schema" };
+//     tao::json::events::from_file (consumer, "export.json");
+//     if (consumer.valid ()) ...
+//
+// Only the schemas that apply to the values currently open are kept.
+// Keywords that need a whole value ("anyOf", "oneOf", "not", "if", "enum" and
+// "const" on containers, "uniqueItems", "contains", "dependentSchemas" and
+// schema "dependencies") make the consumer buffer that value, and only that
+// value, before evaluating it.
+    class
+stream_validator_t
+{
+private:
+        using
+    node_t = detail::compiled_schema_t;
+        using
+    node_ptr = detail::compiled_schema_ptr;
+
+        struct
+    frame_t
+    {
+            bool
+        is_object = false;
+            std::vector <node_ptr>
+        schemas;
+            std::size_t
+        count = 0;
+        // The property names the object keywords look for, and whether they
+        // have been seen.
+            std::vector <std::pair <std::string_view, bool>>
+        keys;
+        // The schemas of the member being parsed.
+            std::vector <node_ptr>
+        member_schemas;
+    };
+
+        const validator_t&
+    validator_m;
+        node_ptr
+    root_m;
+        bool
+    valid_m = true;
+        std::vector <frame_t>
+    stack_m;
+        std::optional <tao::json::events::to_value>
+    buffer_m;
+        std::size_t
+    buffer_depth_m = 0;
+        std::vector <node_ptr>
+    buffer_schemas_m;
+
+    // The schemas that apply to the value that starts now, with the
+    // references and "allOf" flattened.
+        auto
+    schemas_for_value ()
+        -> std::vector <node_ptr>
+    {
+            std::vector <node_ptr>
+        in;
+        if (stack_m.empty ())
+        {
+            in.push_back (root_m);
+        }
+        else if (stack_m.back ().is_object)
+        {
+            in = std::move (stack_m.back ().member_schemas);
+        }
+        else
+        {
+                auto&
+            frame = stack_m.back ();
+            for (auto&& s: frame.schemas)
+            {
+                if (!s->has (detail::kw_items))
+                {
+                    continue;
+                }
+                if (!s->items_is_array)
+                {
+                    in.push_back (s->items);
+                }
+                else if (frame.count < s->items_array.size ())
+                {
+                    in.push_back (s->items_array[frame.count]);
+                }
+                else if (s->has (detail::kw_additional_items))
+                {
+                    in.push_back (s->additional_items);
+                }
+            }
+        }
+            std::vector <node_ptr>
+        out;
+        for (auto&& s: in)
+        {
+            flatten (s, out);
+        }
+        return out;
+    }
+
+        void
+    flatten (node_ptr s, std::vector <node_ptr>& out)
+    {
+        if (s->is_boolean)
+        {
+            valid_m = valid_m && s->boolean_value;
+            return;
+        }
+        if (s->has (detail::kw_ref))
+        {
+            if (!s->ref)
+            {
+                throw (std::runtime_error { fmt::format (
+                      "Resolution of reference \"{}\" failed."
+                    , s->ref_value->get_string ()
+                )});
+            }
+            flatten (s->ref, out);
+            return;
+        }
+        out.push_back (s);
+        for (auto&& sub_schema: s->all_of)
+        {
+            flatten (sub_schema, out);
+        }
+    }
+
+        static bool
+    needs_whole_value (const node_t& s)
+    {
+            using namespace
+        detail;
+            constexpr auto
+        whole_value_keywords =
+              std::uint64_t { 1 } << kw_any_of
+            | std::uint64_t { 1 } << kw_one_of
+            | std::uint64_t { 1 } << kw_not
+            | std::uint64_t { 1 } << kw_if
+            | std::uint64_t { 1 } << kw_enum
+            | std::uint64_t { 1 } << kw_const
+            | std::uint64_t { 1 } << kw_contains
+            | std::uint64_t { 1 } << kw_dependent_schemas
+        ;
+        if (s.keywords & whole_value_keywords)
+        {
+            return true;
+        }
+        if (s.has (kw_unique_items) && s.unique_items)
+        {
+            return true;
+        }
+        return std::any_of (
+              std::begin (s.dependencies)
+            , std::end (s.dependencies)
+            , [](auto&& d) { return d.schema != nullptr; }
+        );
+    }
+
+        void
+    scalar (const json_t& value)
+    {
+        for (auto&& s: schemas_for_value ())
+        {
+            if (valid_m && !validator_m.is_valid_impl (value, *s))
+            {
+                valid_m = false;
+            }
+        }
+    }
+
+        void
+    begin_container (bool is_object)
+    {
+            auto
+        schemas = schemas_for_value ();
+            auto
+        mask = is_object ? detail::type_object : detail::type_array;
+        for (auto&& s: schemas)
+        {
+            if (s->has (detail::kw_type) && !(s->type & mask))
+            {
+                valid_m = false;
+            }
+        }
+        if (std::any_of (
+              std::begin (schemas)
+            , std::end (schemas)
+            , [](auto&& s) { return needs_whole_value (*s); }
+        )){
+            buffer_schemas_m = std::move (schemas);
+            buffer_m.emplace ();
+            buffer_depth_m = 1;
+            if (is_object)
+            {
+                buffer_m->begin_object ();
+            }
+            else
+            {
+                buffer_m->begin_array ();
+            }
+            return;
+        }
+            auto&
+        frame = stack_m.emplace_back ();
+        frame.is_object = is_object;
+        frame.schemas = std::move (schemas);
+        if (!is_object)
+        {
+            return;
+        }
+            auto
+        look_for = [&](std::string_view name)
+        {
+            if (std::none_of (
+                  std::begin (frame.keys)
+                , std::end (frame.keys)
+                , [&](auto&& k) { return k.first == name; }
+            )){
+                frame.keys.emplace_back (name, false);
+            }
+        };
+        for (auto&& s: frame.schemas)
+        {
+            for (auto&& property: s->required)
+            {
+                look_for (*property);
+            }
+            for (auto&& d: s->dependencies)
+            {
+                look_for (*d.property);
+                for (auto&& r: d.required)
+                {
+                    look_for (r);
+                }
+            }
+            for (auto&& [property, required]: s->dependent_required)
+            {
+                look_for (property);
+                for (auto&& r: required)
+                {
+                    look_for (r);
+                }
+            }
+        }
+    }
+
+        void
+    end_buffer ()
+    {
+            auto
+        value = std::move (buffer_m->value);
+        buffer_m.reset ();
+        for (auto&& s: buffer_schemas_m)
+        {
+            if (valid_m && !validator_m.is_valid_impl (value, *s))
+            {
+                valid_m = false;
+            }
+        }
+        buffer_schemas_m.clear ();
+    }
+
+        void
+    end_container ()
+    {
+            auto
+        frame = std::move (stack_m.back ());
+        stack_m.pop_back ();
+            auto
+        seen = [&](std::string_view name)
+        {
+            for (auto&& [k, present]: frame.keys)
+            {
+                if (k == name)
+                {
+                    return present;
+                }
+            }
+            return false;
+        };
+        for (auto&& s: frame.schemas)
+        {
+            if (frame.is_object)
+            {
+                if (
+                       (s->has (detail::kw_max_properties) && frame.count > s->max_properties)
+                    || (s->has (detail::kw_min_properties) && frame.count < s->min_properties)
+                ){
+                    valid_m = false;
+                }
+                for (auto&& property: s->required)
+                {
+                    valid_m = valid_m && seen (*property);
+                }
+                for (auto&& d: s->dependencies)
+                {
+                    if (seen (*d.property))
+                    {
+                        for (auto&& r: d.required)
+                        {
+                            valid_m = valid_m && seen (r);
+                        }
+                    }
+                }
+                for (auto&& [property, required]: s->dependent_required)
+                {
+                    if (seen (property))
+                    {
+                        for (auto&& r: required)
+                        {
+                            valid_m = valid_m && seen (r);
+                        }
+                    }
+                }
+            }
+            else
+            {
+                if (
+                       (s->has (detail::kw_max_items) && frame.count > s->max_items)
+                    || (s->has (detail::kw_min_items) && frame.count < s->min_items)
+                ){
+                    valid_m = false;
+                }
+            }
+        }
+    }
+
+public:
+    // The validator must outlive the consumer.
+    stream_validator_t (const validator_t& validator, std::string const& schema_uri = "")
+        : validator_m { validator }
+        , root_m      { &validator.find_schema (schema_uri) }
+    {}
+
+    // Whether the events received so far form a valid (prefix of a)
+    // document.
+        bool
+    valid () const noexcept
+    {
+        return valid_m;
+    }
+
+    // Forget the events received so far, to validate another document.
+        void
+    reset ()
+    {
+        valid_m = true;
+        stack_m.clear ();
+        buffer_m.reset ();
+        buffer_depth_m = 0;
+        buffer_schemas_m.clear ();
+    }
+
+    // tao::json events consumer interface. While a value is buffered, the
+    // events are forwarded to the buffer.
+        void
+    null ()
+    {
+        if (buffer_m)
+        {
+            buffer_m->null ();
+            return;
+        }
+        scalar (tao::json::null);
+    }
+
+        void
+    boolean (const bool v)
+    {
+        if (buffer_m)
+        {
+            buffer_m->boolean (v);
+            return;
+        }
+        scalar (v);
+    }
+
+        void
+    number (const std::int64_t v)
+    {
+        if (buffer_m)
+        {
+            buffer_m->number (v);
+            return;
+        }
+        scalar (v);
+    }
+
+        void
+    number (const std::uint64_t v)
+    {
+        if (buffer_m)
+        {
+            buffer_m->number (v);
+            return;
+        }
+        scalar (v);
+    }
+
+        void
+    number (const double v)
+    {
+        if (buffer_m)
+        {
+            buffer_m->number (v);
+            return;
+        }
+        scalar (v);
+    }
+
+        void
+    string (const std::string_view v)
+    {
+        if (buffer_m)
+        {
+            buffer_m->string (v);
+            return;
+        }
+        scalar (std::string { v });
+    }
+
+        void
+    begin_array (const std::size_t = 0)
+    {
+        if (buffer_m)
+        {
+            buffer_m->begin_array ();
+            ++buffer_depth_m;
+            return;
+        }
+        begin_container (false);
+    }
+
+        void
+    element ()
+    {
+        if (buffer_m)
+        {
+            buffer_m->element ();
+            return;
+        }
+        ++stack_m.back ().count;
+    }
+
+        void
+    end_array (const std::size_t = 0)
+    {
+        if (buffer_m)
+        {
+            buffer_m->end_array ();
+            if (--buffer_depth_m == 0)
+            {
+                end_buffer ();
+            }
+            return;
+        }
+        end_container ();
+    }
+
+        void
+    begin_object (const std::size_t = 0)
+    {
+        if (buffer_m)
+        {
+            buffer_m->begin_object ();
+            ++buffer_depth_m;
+            return;
+        }
+        begin_container (true);
+    }
+
+        void
+    key (const std::string_view v)
+    {
+        if (buffer_m)
+        {
+            buffer_m->key (v);
+            return;
+        }
+            auto&
+        frame = stack_m.back ();
+        frame.member_schemas.clear ();
+        for (auto&& [k, present]: frame.keys)
+        {
+            if (k == v)
+            {
+                present = true;
+            }
+        }
+            std::optional <json_t>
+        name;
+        for (auto&& s: frame.schemas)
+        {
+                bool
+            apply_additional = true;
+            if (
+                    auto&&
+                  i = s->properties.find (v)
+                ; i != s->properties.end ()
+            ){
+                frame.member_schemas.push_back (i->second);
+                apply_additional = false;
+            }
+            for (auto&& [pattern, regex, sub_schema]: s->pattern_properties)
+            {
+                if (std::regex_search (std::begin (v), std::end (v), *regex))
+                {
+                    frame.member_schemas.push_back (sub_schema);
+                    apply_additional = false;
+                }
+            }
+            if (apply_additional && s->additional_properties)
+            {
+                frame.member_schemas.push_back (s->additional_properties);
+            }
+            if (s->property_names)
+            {
+                if (!name)
+                {
+                    name.emplace (std::string { v });
+                }
+                valid_m = valid_m && validator_m.is_valid_impl (*name, *s->property_names);
+            }
+        }
+    }
+
+        void
+    member ()
+    {
+        if (buffer_m)
+        {
+            buffer_m->member ();
+            return;
+        }
+        ++stack_m.back ().count;
+    }
+
+        void
+    end_object (const std::size_t = 0)
+    {
+        if (buffer_m)
+        {
+            buffer_m->end_object ();
+            if (--buffer_depth_m == 0)
+            {
+                end_buffer ();
+            }
+            return;
+        }
+        end_container ();
+    }
+};
+
+} // namespace calculisto::json_validator
@@ -0,0 +1,76 @@
+#include <doctest/doctest.h>
+#include "../include/calculisto/json_validator/code_generator.hpp"
+    using namespace calculisto::json_validator;
+    namespace json = tao::json;
+
+TEST_CASE("code_generator.hpp")
+{
+        code_generator_t
+    generator {
+          { {
+              json::from_string (R"({
+                  "type": "array"
+                , "items": { "$ref": "#/definitions/record" }
+                , "definitions": {
+                      "record": {
+                          "type": "object"
+                        , "required": [ "id" ]
+                        , "properties": {
+                              "id": { "type": "integer", "minimum": 0 }
+                            , "name": { "type": "string", "pattern": "^[A-Z]" }
+                          }
+                        , "additionalProperties": false
+                      }
+                  }
+              })")
+            , "http://example.com/records"
+          } }
+        , "http://example.com/records"
+        , "records"
+    };
+        auto const
+    header = generator.generate ();
+    CHECK (header == generator.generate ());
+    CHECK (header.find ("namespace\nrecords\n") != std::string::npos);
+    CHECK (header.find ("is_valid (") != std::string::npos);
+    CHECK (header.find ("validate (") != std::string::npos);
+    // The reference is a direct call of the function of its target.
+    CHECK (header.find ("if (!schema_1 (array[index])) return false;") != std::string::npos);
+    // Properties are dispatched on the length of their name.
+    CHECK (header.find ("switch (property.size ())") != std::string::npos);
+    CHECK (header.find ("if (property == \"name\"sv)") != std::string::npos);
+    // Regular expressions are compiled once.
+    CHECK (header.find ("std::regex { std::string { \"^[A-Z]\"sv } };") != std::string::npos);
+    CHECK (header.find ("if (!(object.find (\"id\"sv) != object.end ())) return false;") != std::string::npos);
+    CHECK (detail::cpp_literal (std::string_view { "a\"\\\n\0b1", 7 }) == R"("a\"\\\n\000b1"sv)");
+    CHECK (detail::cpp_double (1) == "1.0");
+    CHECK (detail::cpp_double (0.1) == "0.10000000000000001");
+    // A discriminated "oneOf" only calls the branches of the value of its
+    // property.
+        code_generator_t
+    shapes {
+          { {
+              json::from_string (R"({
+                  "oneOf": [
+                      { "required": [ "kind" ], "properties": { "kind": { "const": "circle" }, "r": { "type": "number" } } }
+                    , { "required": [ "kind" ], "properties": { "kind": { "enum": [ "square", "rect" ] }, "w": { "type": "number" } } }
+                    , { "required": [ "kind" ], "properties": { "kind": { "const": "line" } } }
+                  ]
+              })")
+            , "http://example.com/shapes"
+          } }
+        , "http://example.com/shapes"
+        , "shapes"
+    };
+        auto const
+    shapes_header = shapes.generate ();
+    CHECK (shapes_header.find ("auto const i = instance.get_object ().find (\"kind\"sv);") != std::string::npos);
+    CHECK (shapes_header.find ("switch (value.size ())") != std::string::npos);
+    CHECK (shapes_header.find ("if (value == \"circle\"sv)") != std::string::npos);
+    CHECK (shapes_header.find ("if (value == \"rect\"sv)") != std::string::npos);
+    // One call per value, and one per branch for the instances that are not
+    // objects.
+    CHECK (shapes_header.find ("if (schema_1 (instance) && ++successes > 1) return false;") != std::string::npos);
+    CHECK (shapes_header.find ("if (schema_2 (instance) && ++successes > 1) return false;") != std::string::npos);
+    CHECK_THROWS (code_generator_t { { { json::from_string (R"({ "type": "integer" })"), "http://example.com/a" } }, "http://example.com/b", "b" }.generate ());
+}
@@ -0,0 +1,134 @@
+#include <doctest/doctest.h>
+#include "../include/calculisto/json_validator/incremental_validator.hpp"
+    using namespace calculisto::json_validator;
+    namespace json = tao::json;
+
+TEST_CASE("incremental_validator.hpp")
+{
+        validator_t
+    validator;
+    validator.add_schema (
+          json::from_string (R"({
+              "type": "object"
+            , "required": [ "services" ]
+            , "properties": {
+                  "services": {
+                      "type": "array"
+                    , "items": { "$ref": "#/definitions/service" }
+                    , "uniqueItems": true
+                    , "contains": { "properties": { "primary": { "const": true } }, "required": [ "primary" ] }
+                  }
+                , "owner": { "anyOf": [ { "type": "string" }, { "type": "null" } ] }
+              }
+            , "additionalProperties": false
+            , "definitions": {
+                  "service": {
+                      "type": "object"
+                    , "required": [ "name", "port" ]
+                    , "properties": {
+                          "name": { "type": "string", "minLength": 1 }
+                        , "port": { "type": "integer", "minimum": 1, "maximum": 65535 }
+                        , "primary": { "type": "boolean" }
+                        , "tags": { "type": "array", "items": { "type": "string" } }
+                      }
+                    , "not": { "required": [ "disabled" ] }
+                  }
+              }
+          })")
+        , "http://example.com/config"
+    );
+        json::value
+    config = json::from_string (R"({ "services": [], "owner": null })");
+    for (auto i = 0; i < 200; ++i)
+    {
+        config["services"].push_back (json::value {
+              { "name", fmt::format ("service{}", i) }
+            , { "port", 1000 + i }
+            , { "primary", i == 0 }
+            , { "tags", json::value::array_t { "a", "b" } }
+        });
+    }
+        incremental_validator_t
+    incremental { validator };
+        validation_trace_t
+    trace;
+        auto
+    full = incremental.validate (config, trace);
+    CHECK (full.valid ());
+    CHECK (trace.size () > 200);
+        std::vector <json::value> const
+    patches {
+          json::from_string (R"([ { "op": "replace", "path": "/services/5/port", "value": 0 } ])")
+        , json::from_string (R"([ { "op": "replace", "path": "/services/5/port", "value": 8080 } ])")
+        , json::from_string (R"([ { "op": "add", "path": "/services/7/tags/-", "value": 3 } ])")
+        , json::from_string (R"([ { "op": "remove", "path": "/services/7/tags/2" } ])")
+        , json::from_string (R"([ { "op": "add", "path": "/services/3", "value": { "name": "new", "port": 9 } } ])")
+        , json::from_string (R"([ { "op": "add", "path": "/services/10/disabled", "value": true } ])")
+        , json::from_string (R"([ { "op": "remove", "path": "/services/10/disabled" } ])")
+        , json::from_string (R"([ { "op": "copy", "from": "/services/1", "path": "/services/-" } ])")
+        , json::from_string (R"([ { "op": "remove", "path": "/services/201" } ])")
+        , json::from_string (R"([ { "op": "replace", "path": "/services/0/primary", "value": false } ])")
+        , json::from_string (R"([ { "op": "replace", "path": "/services/2/primary", "value": true } ])")
+        , json::from_string (R"([ { "op": "move", "from": "/services/2", "path": "/services/0" } ])")
+        , json::from_string (R"([ { "op": "test", "path": "/services/0/primary", "value": true }, { "op": "replace", "path": "/owner", "value": "ops" } ])")
+        , json::from_string (R"([ { "op": "add", "path": "/extra", "value": 1 } ])")
+        , json::from_string (R"([ { "op": "remove", "path": "/extra" }, { "op": "remove", "path": "/services/3" } ])")
+        , json::from_string (R"([ { "op": "replace", "path": "/services", "value": [] } ])")
+        , json::from_string (R"([ { "op": "add", "path": "/services/0", "value": { "name": "x", "port": 1, "primary": true } } ])")
+    };
+    for (auto&& patch: patches)
+    {
+            auto
+        result = incremental.apply_patch (config, trace, patch);
+            auto
+        expected = validator.evaluate (config);
+        CHECK_MESSAGE (result.valid () == expected.valid (), json::to_string (patch));
+        CHECK_MESSAGE (result.errors () == expected.errors (), json::to_string (patch));
+        // The services that did not change are not evaluated again.
+        CHECK_MESSAGE (result.nodes_visited () < expected.nodes_visited () / 4 + 10, json::to_string (patch));
+    }
+    CHECK (incremental.apply_patch (config, trace, json::empty_array).valid ());
+    // Failed operations.
+    CHECK_THROWS (incremental.apply_patch (config, trace, json::from_string (R"([ { "op": "remove", "path": "/nothing" } ])")));
+    CHECK_THROWS (incremental.apply_patch (config, trace, json::from_string (R"([ { "op": "add", "path": "/services/2", "value": 1 } ])")));
+    CHECK_THROWS (incremental.apply_patch (config, trace, json::from_string (R"([ { "op": "add", "path": "/services/01", "value": 1 } ])")));
+    CHECK_THROWS (incremental.apply_patch (config, trace, json::from_string (R"([ { "op": "test", "path": "/owner", "value": "dev" } ])")));
+    CHECK_THROWS (incremental.apply_patch (config, trace, json::from_string (R"([ { "op": "move", "from": "/services", "path": "/services/0/x" } ])")));
+    CHECK_THROWS (incremental.apply_patch (config, trace, json::from_string (R"([ { "op": "swap", "path": "/owner" } ])")));
+    CHECK (incremental.apply_patch (config, trace, json::empty_array).valid ());
+    // A patch is applied as a whole or not at all. Undoing it only forgets
+    // the outcomes of the nodes it touched.
+        json::value
+    services = json::empty_array;
+    for (auto i = 0; i < 200; ++i)
+    {
+        services.push_back (json::value { { "name", fmt::format ("service{}", i) }, { "port", 1000 + i }, { "primary", i == 0 } });
+    }
+    incremental.apply_patch (config, trace, json::value::array_t { json::value { { "op", "replace" }, { "path", "/services" }, { "value", services } } });
+        auto const
+    before = config;
+    for (auto&& patch: {
+          R"([ { "op": "replace", "path": "/owner", "value": "ops" }, { "op": "test", "path": "/owner", "value": "dev" } ])"
+        , R"([ { "op": "add", "path": "/services/0/tags", "value": [ "z" ] }, { "op": "remove", "path": "/services/1/name" }, { "op": "add", "path": "/extra", "value": 1 }, { "op": "remove", "path": "/nothing" } ])"
+        , R"([ { "op": "move", "from": "/services/0", "path": "/services/-" }, { "op": "copy", "from": "/owner", "path": "/services/1/name" }, { "op": "swap", "path": "/owner" } ])"
+        , R"([ { "op": "remove", "path": "/services/5" }, { "op": "replace", "path": "", "value": {} }, { "op": "test", "path": "/services", "value": 1 } ])"
+    }){
+        CHECK_THROWS (incremental.apply_patch (config, trace, json::from_string (patch)));
+        CHECK_MESSAGE (config == before, patch);
+            auto
+        result = incremental.apply_patch (config, trace, json::empty_array);
+            auto
+        expected = validator.evaluate (config);
+        CHECK (result.valid ());
+        CHECK (expected.nodes_visited () > 600);
+        // But when the whole document was replaced.
+        if (std::string_view { patch }.find (R"("path": "")") == std::string_view::npos)
+        {
+            CHECK_MESSAGE (result.nodes_visited () < expected.nodes_visited () / 4 + 10, patch);
+        }
+    }
+    // A trace only goes with its instance.
+        json::value
+    other = config;
+    CHECK_THROWS (incremental.apply_patch (other, trace, json::empty_array));
+}
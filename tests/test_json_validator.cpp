@@ -1,7 +1,9 @@
 #include <doctest/doctest.h>
 #include "../include/calculisto/json_validator/json_validator.hpp"
     using namespace calculisto::json_validator;
+#include <algorithm>
 #include <filesystem>
+#include <thread>
     namespace fs = std::filesystem;
     using namespace std::literals;
     namespace json = tao::json;
@@ -81,7 +83,795 @@ TEST_CASE("json_validator.hpp")
                     auto
                 expected = test.at ("valid").get_boolean ();
                 CHECK_MESSAGE (result == expected, fmt::format ("in file {} with schema {}, {} with data {}\n", p.path ().native (), test_suite.at ("schema"), test.at ("description"), test.at ("data")));
+                CHECK_MESSAGE (validator.is_valid (test.at ("data")) == result, fmt::format ("is_valid disagrees with validate in file {} with schema {}, {} with data {}\n", p.path ().native (), test_suite.at ("schema"), test.at ("description"), test.at ("data")));
             }
         }
     }
 } // TEST_CASE("json_validator.hpp")
+
+TEST_CASE("json_validator.hpp: invalid patterns are reported by add_schema")
+{
+        validator_t
+    validator;
+    CHECK_THROWS_AS (
+          validator.add_schema (
+              json::from_string (R"({ "pattern": "(" })")
+            , "http://example.com/pattern"
+          )
+        , std::runtime_error
+    );
+    CHECK_THROWS_AS (
+          validator.add_schema (
+              json::from_string (R"({ "patternProperties": { "[": true } })")
+            , "http://example.com/pattern-properties"
+          )
+        , std::runtime_error
+    );
+} // TEST_CASE("json_validator.hpp: invalid patterns are reported by add_schema")
+
+TEST_CASE("json_validator.hpp: errors are only rendered on demand")
+{
+        validator_t
+    validator;
+    validator.add_schema (
+          json::from_string (R"({ 
+              "properties": { "a/b": { "type": "integer" } }
+            , "required": [ "c" ] 
+          })")
+        , "http://example.com/lazy"
+    );
+        auto
+    valid = validator.evaluate (json::from_string (R"({ "a/b": 1, "c": 2 })"));
+    CHECK (valid.valid ());
+    CHECK (valid.entries ().empty ());
+    CHECK (valid.errors ().is_null ());
+        auto
+    invalid = validator.evaluate (json::from_string (R"({ "a/b": "x" })"));
+    CHECK_FALSE (invalid.valid ());
+        auto
+    errors = invalid.errors ();
+    CHECK (errors.at ("schemaLocation") == "#/properties/a~1b");
+    CHECK (errors.at ("errors").at ("instanceLocation") == "//a~1b");
+    CHECK (validator.validate (json::from_string (R"({ "a/b": "x" })")).second == errors);
+} // TEST_CASE("json_validator.hpp: errors are only rendered on demand")
+
+TEST_CASE("json_validator.hpp: nodes visited")
+{
+        validator_t
+    validator;
+    validator.add_schema (
+          json::from_string (R"({
+              "type": "array"
+            , "items": { "$ref": "#/definitions/item" }
+            , "definitions": { "item": { "type": "integer" } }
+          })")
+        , "http://example.com/visited"
+    );
+    // The array, then each item and the sub-schema it refers to.
+    CHECK (validator.evaluate (json::from_string ("[]")).nodes_visited () == 1);
+    CHECK (validator.evaluate (json::from_string ("[ 1, 2, 3 ]")).nodes_visited () == 7);
+        validation_context_t
+    context;
+    CHECK (validator.evaluate (json::from_string ("[ 1, 2 ]"), context).nodes_visited () == 5);
+    CHECK (validator.evaluate (json::from_string ("[ 1 ]"), context).nodes_visited () == 3);
+    // The branches of "anyOf" are evaluated without diagnostics, and count
+    // all the same.
+    validator.add_schema (
+          json::from_string (R"({
+              "items": { "anyOf": [ { "type": "string" }, { "type": "boolean" }, { "type": "integer" } ] }
+          })")
+        , "http://example.com/visited/anyOf"
+    );
+    // The array, then each item, its "anyOf" and the branches it tries.
+    CHECK (validator.evaluate (json::from_string ("[ 1, 2 ]"), "http://example.com/visited/anyOf").nodes_visited () == 9);
+    CHECK (validator.evaluate (json::from_string (R"([ "a", 2 ])"), "http://example.com/visited/anyOf").nodes_visited () == 7);
+    CHECK (validator.evaluate (json::from_string ("[ null ]"), "http://example.com/visited/anyOf").nodes_visited () == 5);
+} // TEST_CASE("json_validator.hpp: nodes visited")
+
+TEST_CASE("json_validator.hpp: memoization")
+{
+    // Each level refers twice to the one below: 2^depth evaluations of level
+    // 0 without memoization. With "allOf", the references are evaluated with
+    // diagnostics, with "anyOf" and "oneOf" without.
+        validator_t
+    validator;
+        json::value
+    definitions;
+    for (auto&& applicator: { "allOf", "anyOf", "oneOf" })
+    {
+            auto
+        depth = std::string_view { applicator } == "allOf" ? 16 : 14;
+        definitions = json::empty_object;
+        definitions["level0"] = json::from_string (R"({ "type": "integer", "minimum": 0 })");
+        for (auto level = 1; level <= depth; ++level)
+        {
+            definitions[fmt::format ("level{}", level)] = json::from_string (fmt::format (
+                  R"({{ "{0}": [ {{ "$ref": "#/definitions/level{1}" }}, {{ "$ref": "#/definitions/level{1}", "$comment": "again" }} ] }})"
+                , applicator
+                , level - 1
+            ));
+        }
+            auto
+        uri = fmt::format ("http://example.com/memoization/{}", applicator);
+        validator.add_schema (
+              json::value { { "$ref", fmt::format ("#/definitions/level{}", depth) }, { "definitions", definitions } }
+            , uri
+        );
+            validation_context_t
+        plain;
+            validation_context_t
+        memoized;
+        memoized.memoize (true);
+        for (auto&& instance: { json::value { 1 }, json::value { -1 }, json::value { "1" } })
+        {
+                auto
+            expected = validator.evaluate (instance, plain, uri);
+                auto
+            result = validator.evaluate (instance, memoized, uri);
+            CHECK_MESSAGE (result.valid () == expected.valid (), applicator);
+            CHECK_MESSAGE (result.errors ().is_null () == expected.errors ().is_null (), applicator);
+            // "anyOf" stops at the first valid branch.
+            if (std::string_view { applicator } != "anyOf" || !expected.valid ())
+            {
+                CHECK_MESSAGE (expected.nodes_visited () > (std::size_t { 1 } << depth), applicator);
+                CHECK_MESSAGE (result.nodes_visited () < 100, applicator);
+            }
+        }
+    }
+        validation_context_t
+    memoized;
+    memoized.memoize (true);
+    // Property names are temporaries: they are not memoized.
+    validator.add_schema (
+          json::from_string (R"({
+              "propertyNames": { "$ref": "#/definitions/name" }
+            , "additionalProperties": { "$ref": "#/definitions/name" }
+            , "definitions": { "name": { "maxLength": 2 } }
+          })")
+        , "http://example.com/names"
+    );
+    CHECK (validator.evaluate (json::from_string (R"({ "a": "b", "c": "d" })"), memoized).valid ());
+    CHECK_FALSE (validator.evaluate (json::from_string (R"({ "a": "b", "long": "d" })"), memoized).valid ());
+    CHECK_FALSE (validator.evaluate (json::from_string (R"({ "long": "b", "a": "d" })"), memoized).valid ());
+    // The meta-schema, with a deeply nested schema: "items" is an "anyOf"
+    // of "#" and of an array of schemas.
+    CHECK (validator.validate_schema (definitions, memoized) == validator.validate_schema (definitions));
+        json::value
+    nested = json::from_string (R"({ "type": 5 })");
+    for (auto level = 0; level < 200; ++level)
+    {
+        nested = json::value { { "items", std::move (nested) } };
+    }
+        auto
+    expected = validator.validate_schema (nested);
+    CHECK_FALSE (expected.first);
+    CHECK (validator.validate_schema (nested, memoized) == expected);
+} // TEST_CASE("json_validator.hpp: memoization")
+
+TEST_CASE("json_validator.hpp: error budgets")
+{
+        validator_t
+    validator;
+    validator.add_schema (
+          json::from_string (R"({
+              "type": "array"
+            , "items": { "allOf": [ { "type": "integer" }, { "minimum": 0 } ] }
+          })")
+        , "http://example.com/budget"
+    );
+        json::value
+    items = json::empty_array;
+    for (auto i = 0; i < 1000; ++i)
+    {
+        items.push_back (-0.5);
+    }
+        auto
+    all = validator.evaluate (items);
+    CHECK_FALSE (all.valid ());
+    CHECK_FALSE (all.truncated ());
+    CHECK (all.errors ().at ("errors").get_array ().size () == 1000);
+    // The total.
+        auto
+    capped = validator.evaluate (items, validation_options_t { .max_errors = 10 });
+    CHECK_FALSE (capped.valid ());
+    CHECK (capped.truncated ());
+    CHECK (capped.entries ().size () <= 12);
+    CHECK (capped.suppressed_errors () > 990);
+    CHECK (capped.errors ().at ("truncated") == true);
+    CHECK (capped.errors ().at ("suppressedErrors") == capped.suppressed_errors ());
+    // Per branch.
+        auto
+    branches = validator.evaluate (items, validation_options_t { .max_branch_errors = 3 });
+    CHECK (branches.truncated ());
+    CHECK (branches.suppressed_errors () == 997);
+    CHECK (branches.errors ().at ("errors").get_array ().size () == 3);
+    CHECK (branches.errors ().at ("errors").get_array ()[0].at ("errors").get_array ().size () == 2);
+    CHECK (validator.validate (items, validation_options_t { .max_branch_errors = 1 }).second.at ("errors").get_array ()[0].at ("errors").get_array ().size () == 1);
+    // The validity is unchanged, and nothing is dropped below the limits.
+    items.get_array ().assign (1000, json::value { 1 });
+    CHECK (validator.evaluate (items, validation_options_t { .max_errors = 1 }).valid ());
+    items.get_array ()[500] = "x";
+        auto
+    one = validator.evaluate (items, validation_options_t { .max_errors = 10, .max_branch_errors = 3 });
+    CHECK_FALSE (one.valid ());
+    CHECK_FALSE (one.truncated ());
+    CHECK (one.errors () == validator.validate (items).second);
+        validation_context_t
+    context;
+    context.options ({ .max_errors = 1 });
+    CHECK (validator.evaluate (json::from_string ("[ -1, -2 ]"), context).suppressed_errors () == 1);
+    context.options ({});
+    CHECK_FALSE (validator.evaluate (json::from_string ("[ -1, -2 ]"), context).truncated ());
+    // An "allOf" or "items" whose failures are all past the budget is a
+    // leaf: it has no "errors".
+        detail::context_t
+    exhausted;
+    exhausted.max_errors = 1;
+    exhausted.record (detail::error_entry_t::leaf, { "/type" }, "Type mismatch");
+        auto
+    all_of = exhausted.record (detail::error_entry_t::array, { "/allOf" }, "not all sub-schemas validate the instance", { detail::no_error, detail::no_error });
+    CHECK (exhausted.entries[all_of].kind == detail::error_entry_t::leaf);
+    CHECK_FALSE (detail::render_error (exhausted.entries, all_of).get_object ().contains ("errors"));
+        auto
+    kept = exhausted.record (detail::error_entry_t::array, { "/items" }, "Not all items validate", { 0, detail::no_error });
+    CHECK (exhausted.entries[kept].kind == detail::error_entry_t::array);
+    CHECK (detail::render_error (exhausted.entries, kept).at ("errors").get_array ().size () == 1);
+} // TEST_CASE("json_validator.hpp: error budgets")
+
+TEST_CASE("json_validator.hpp: numeric items")
+{
+    // The kernels agree with the scalar version.
+        std::vector <double>
+    values;
+    for (auto i = 0; i < 64; ++i)
+    {
+        values.push_back (i % 7 == 0 ? -0.5 * i : 0.25 * i);
+    }
+        detail::simd::range_t
+    range { .minimum = -10, .maximum = 12, .exclusive_minimum = -20, .exclusive_maximum = 11.75 };
+    for (std::size_t count = 0; count <= values.size (); ++count)
+    {
+            auto
+        expected = detail::simd::out_of_range_scalar (values.data (), count, range);
+        CHECK (detail::simd::out_of_range (values.data (), count, range) == expected);
+#ifdef CALCULISTO_JSON_VALIDATOR_X86
+        if (__builtin_cpu_supports ("avx2"))
+        {
+            CHECK (detail::simd::out_of_range_avx2 (values.data (), count, range) == expected);
+        }
+        CHECK (detail::simd::out_of_range_sse2 (values.data (), count, range) == expected);
+#endif
+    }
+    // An "items" sub-schema checked in bulk gives the results of the same
+    // one with "pattern", which only applies to strings, checked item by
+    // item.
+        json::value
+    items = json::empty_array;
+    for (auto i = 0; i < 1000; ++i)
+    {
+        switch (i % 10)
+        {
+            case 0:
+                items.push_back (i * 3);
+                break;
+            case 1:
+                items.push_back (-i);
+                break;
+            case 2:
+                items.push_back (i + 0.5);
+                break;
+            case 3:
+                items.push_back (static_cast <std::uint64_t> (i) << 54);
+                break;
+            case 4:
+                items.push_back (i % 20 == 4 ? json::value { json::null } : json::value { true });
+                break;
+            case 5:
+                items.push_back (static_cast <double> (i));
+                break;
+            default:
+                items.push_back (i % 1000);
+        }
+    }
+    items.push_back (999);
+    items.push_back (1000);
+    items.push_back (-2.25);
+    items.push_back (500.5);
+    for (auto&& item_schema: {
+          R"({ "type": "integer", "minimum": 0, "exclusiveMaximum": 1000, "multipleOf": 3 })"
+        , R"({ "type": "number", "maximum": 500.5, "exclusiveMinimum": -2.25 })"
+        , R"({ "minimum": 0, "format": "int32" })"
+        , R"({ "type": [ "integer", "null" ], "maximum": 18014398509481984 })"
+        , R"({ "type": "number", "multipleOf": 0.5, "maximum": 1e300 })"
+    }){
+            validator_t
+        bulk;
+        bulk.add_schema (
+              json::from_string (fmt::format (R"({{ "type": "array", "items": {} }})", item_schema))
+            , "http://example.com/numbers"
+        );
+            auto
+        item_by_item_schema = json::from_string (item_schema);
+        item_by_item_schema["pattern"] = "^";
+            validator_t
+        item_by_item;
+        item_by_item.add_schema (
+              json::value { { "type", "array" }, { "items", item_by_item_schema } }
+            , "http://example.com/numbers"
+        );
+            auto
+        expected = item_by_item.evaluate (items);
+            auto
+        result = bulk.evaluate (items);
+        CHECK_MESSAGE (result.valid () == expected.valid (), item_schema);
+        CHECK_MESSAGE (result.errors () == expected.errors (), item_schema);
+        CHECK_MESSAGE (result.nodes_visited () == expected.nodes_visited (), item_schema);
+        CHECK_MESSAGE (bulk.is_valid (items) == expected.valid (), item_schema);
+            json::value
+        valid = json::empty_array;
+        for (auto&& item: items.get_array ())
+        {
+            if (item_by_item.is_valid (json::value::array_t { item }))
+            {
+                valid.push_back (item);
+            }
+        }
+        CHECK_MESSAGE (valid.get_array ().size () > 100, item_schema);
+        CHECK_MESSAGE (bulk.is_valid (valid), item_schema);
+        CHECK_MESSAGE (bulk.evaluate (valid).nodes_visited () == valid.get_array ().size () + 1, item_schema);
+    }
+} // TEST_CASE("json_validator.hpp: numeric items")
+
+TEST_CASE("json_validator.hpp: string lengths")
+{
+    // The kernels agree with the scalar version.
+        std::string
+    text;
+    for (auto i = 0; i < 40; ++i)
+    {
+        text += i % 3 ? "abcdefgh" : "é€😀x";
+    }
+    for (std::size_t size = 0; size <= text.size (); ++size)
+    {
+            auto
+        expected = detail::simd::code_points_scalar (text.data (), size);
+        CHECK (detail::simd::code_points (text.data (), size) == expected);
+#ifdef CALCULISTO_JSON_VALIDATOR_X86
+        if (__builtin_cpu_supports ("avx2"))
+        {
+            CHECK (detail::simd::code_points_avx2 (text.data (), size) == expected);
+        }
+        CHECK (detail::simd::code_points_sse2 (text.data (), size) == expected);
+#endif
+    }
+    CHECK (detail::simd::code_points (text.data (), text.size ()) == 14 * 4 + 26 * 8);
+    // Lengths are in code points.
+        validator_t
+    validator;
+    validator.add_schema (
+          json::from_string (R"({ "maxLength": 3, "minLength": 2 })")
+        , "http://example.com/lengths"
+    );
+    CHECK (validator.is_valid (json::value { "ab" }, "http://example.com/lengths"));
+    CHECK (validator.is_valid (json::value { "éé" }, "http://example.com/lengths"));
+    CHECK (validator.is_valid (json::value { "😀😀😀" }, "http://example.com/lengths"));
+    CHECK_FALSE (validator.is_valid (json::value { "😀" }, "http://example.com/lengths"));
+    CHECK_FALSE (validator.is_valid (json::value { "😀😀😀😀" }, "http://example.com/lengths"));
+    CHECK_FALSE (validator.validate (json::value { "ééé€" }, "http://example.com/lengths").first);
+    CHECK_FALSE (validator.validate (json::value { "a" }, "http://example.com/lengths").first);
+    CHECK (validator.validate (json::value { "a€" }, "http://example.com/lengths").first);
+    // Past the blocks of the kernels.
+        std::string
+    long_text;
+    for (auto i = 0; i < 100; ++i)
+    {
+        long_text += i % 2 ? "é" : "abc";
+    }
+    validator.add_schema (
+          json::from_string (R"({ "maxLength": 200, "minLength": 200 })")
+        , "http://example.com/long"
+    );
+    CHECK (validator.is_valid (json::value { long_text }, "http://example.com/long"));
+    CHECK_FALSE (validator.is_valid (json::value { long_text + "a" }, "http://example.com/long"));
+    CHECK_FALSE (validator.is_valid (json::value { long_text.substr (1) }, "http://example.com/long"));
+} // TEST_CASE("json_validator.hpp: string lengths")
+
+TEST_CASE("json_validator.hpp: formats")
+{
+    using detail::formats::format_t;
+        std::vector <std::tuple <format_t, std::string_view, bool>> const
+    cases {
+          { format_t::date_time, "1963-06-19T08:30:06.283185Z", true }
+        , { format_t::date_time, "1963-06-19t08:30:06z", true }
+        , { format_t::date_time, "1990-12-31T15:59:60.123-08:00", true }
+        , { format_t::date_time, "1990-12-31T23:59:60Z", true }
+        , { format_t::date_time, "1990-12-31T22:59:60Z", false }
+        , { format_t::date_time, "1990-12-31T23:59:61Z", false }
+        , { format_t::date_time, "1963-06-19T08:30:06", false }
+        , { format_t::date_time, "1963-06-19 08:30:06Z", false }
+        , { format_t::date_time, "2020-02-30T00:00:00Z", false }
+        , { format_t::date_time, "1963-06-19T08:30:06+24:00", false }
+        , { format_t::date, "2020-02-29", true }
+        , { format_t::date, "2019-02-29", false }
+        , { format_t::date, "1900-02-29", false }
+        , { format_t::date, "2000-02-29", true }
+        , { format_t::date, "2020-1-01", false }
+        , { format_t::time, "08:30:06.283185+01:30", true }
+        , { format_t::time, "08:30:06.Z", false }
+        , { format_t::time, "24:00:00Z", false }
+        , { format_t::email, "joe.bloggs@example.com", true }
+        , { format_t::email, "te~st@example.com", true }
+        , { format_t::email, "\"joe bloggs\"@example.com", true }
+        , { format_t::email, "joe@[127.0.0.1]", true }
+        , { format_t::email, "joe@[IPv6:::1]", true }
+        , { format_t::email, ".joe@example.com", false }
+        , { format_t::email, "joe.@example.com", false }
+        , { format_t::email, "jo..e@example.com", false }
+        , { format_t::email, "2962", false }
+        , { format_t::email, "joe@-example.com", false }
+        , { format_t::hostname, "www.example.com", true }
+        , { format_t::hostname, "xn--4gbwdl.xn--wgbh1c", true }
+        , { format_t::hostname, "-a-host-name-that-starts-with--", false }
+        , { format_t::hostname, "not_a_valid_host_name", false }
+        , { format_t::hostname, std::string_view { "a-vvvvvvvvvvvvvvvveeeeeeeeeeeeeeeerrrrrrrrrrrrrrrryyyyyyyyyyyyyyyy-long-host-name-component" }, false }
+        , { format_t::hostname, "a..b", false }
+        , { format_t::hostname, "", false }
+        , { format_t::ipv4, "192.168.0.1", true }
+        , { format_t::ipv4, "127.0.0.0.1", false }
+        , { format_t::ipv4, "256.256.256.256", false }
+        , { format_t::ipv4, "087.10.0.1", false }
+        , { format_t::ipv4, "1.2.3", false }
+        , { format_t::ipv6, "::1", true }
+        , { format_t::ipv6, "::", true }
+        , { format_t::ipv6, "1:2:3:4:5:6:7:8", true }
+        , { format_t::ipv6, "1::8", true }
+        , { format_t::ipv6, "::ffff:192.168.0.1", true }
+        , { format_t::ipv6, "12345::", false }
+        , { format_t::ipv6, "1:2:3:4:5:6:7:8:9", false }
+        , { format_t::ipv6, "1::2::3", false }
+        , { format_t::ipv6, "1:2:3:4:5:6:7", false }
+        , { format_t::ipv6, "::laptop", false }
+        , { format_t::ipv6, "1:", false }
+        , { format_t::uri, "http://foo.bar/?baz=qux#quux", true }
+        , { format_t::uri, "urn:oasis:names:specification:docbook:dtd:xml:4.1.2", true }
+        , { format_t::uri, "http://example.com/%7Efoo", true }
+        , { format_t::uri, "//foo.bar/?baz=qux#quux", false }
+        , { format_t::uri, "http:// shouldfail.com", false }
+        , { format_t::uri, "http://example.com/%7", false }
+        , { format_t::uri, "http://example.com/a#b#c", false }
+        , { format_t::uri_reference, "/abc", true }
+        , { format_t::uri_reference, "#fragment", true }
+        , { format_t::uri_reference, "http://foo.bar/?baz=qux#quux", true }
+        , { format_t::uri_reference, "\\\\WINDOWS\\fileshare", false }
+        , { format_t::uri_reference, "a:b:c", true }
+        , { format_t::uri_reference, "1a:b", false }
+        , { format_t::uuid, "2eb8aa08-aa98-11ea-b4aa-73b441d16380", true }
+        , { format_t::uuid, "2eb8aa08-aa98-11ea-b4aa-73b441d1638", false }
+        , { format_t::uuid, "2eb8aa08aa98-11ea-b4aa-73b441d16380-", false }
+        , { format_t::json_pointer, "", true }
+        , { format_t::json_pointer, "/foo/0/~0~1", true }
+        , { format_t::json_pointer, "/foo/~2", false }
+        , { format_t::json_pointer, "foo", false }
+        , { format_t::relative_json_pointer, "1", true }
+        , { format_t::relative_json_pointer, "0#", true }
+        , { format_t::relative_json_pointer, "2/foo/0", true }
+        , { format_t::relative_json_pointer, "01", false }
+        , { format_t::relative_json_pointer, "/foo", false }
+        , { format_t::regex, "([abc])+\\s+$", true }
+        , { format_t::regex, "(?<year>\\d{4})-(?:x|y){1,3}?", true }
+        , { format_t::regex, "a{2", true }
+        , { format_t::regex, "^(abc]", false }
+        , { format_t::regex, "\\a", false }
+        , { format_t::regex, "a**", false }
+        , { format_t::regex, "a{3,1}", false }
+        , { format_t::regex, "(?x)", false }
+        , { format_t::regex, "[a-z", false }
+    };
+    for (auto&& [format, text, valid]: cases)
+    {
+        CHECK_MESSAGE (detail::formats::check (format, text) == valid, text);
+    }
+    CHECK (detail::formats::format_from ("date-time") == format_t::date_time);
+    CHECK (detail::formats::format_from ("idn-email") == format_t::unknown);
+    // An annotation, unless asserted.
+        validator_t
+    validator;
+    validator.add_schema (
+          json::from_string (R"({
+              "properties": {
+                  "at": { "format": "date-time" }
+                , "host": { "format": "hostname" }
+                , "other": { "format": "color" }
+              }
+          })")
+        , "http://example.com/formats"
+    );
+        auto const
+    instance = json::from_string (R"({ "at": "yesterday", "host": "example.com", "other": "#fff" })");
+    CHECK (validator.is_valid (instance));
+    CHECK (validator.validate (instance).first);
+    validator.assert_formats (true);
+    CHECK_FALSE (validator.is_valid (instance));
+        auto
+    [valid, errors] = validator.validate (instance);
+    CHECK_FALSE (valid);
+    CHECK (json::to_string (errors).find (R"(String is not a valid \"date-time\")") != std::string::npos);
+    CHECK (validator.is_valid (json::from_string (R"({ "at": "2020-01-01T00:00:00Z", "host": "example.com", "other": 1 })")));
+} // TEST_CASE("json_validator.hpp: formats")
+
+TEST_CASE("json_validator.hpp: uniqueItems")
+{
+    using detail::hash_value;
+    CHECK (hash_value (json::from_string ("1")) == hash_value (json::from_string ("1.0")));
+    CHECK (hash_value (json::from_string ("-0.0")) == hash_value (json::from_string ("0")));
+    CHECK (
+           hash_value (json::from_string (R"({ "a": 1, "b": [ 2, { "c": null } ] })"))
+        == hash_value (json::from_string (R"({ "b": [ 2.0, { "c": null } ], "a": 1.0 })"))
+    );
+    CHECK (hash_value (json::from_string ("[ 1, 2 ]")) != hash_value (json::from_string ("[ 2, 1 ]")));
+        validator_t
+    validator;
+    validator.add_schema (
+          json::from_string (R"({ "uniqueItems": true })")
+        , "http://example.com/unique"
+    );
+    CHECK (validator.is_valid (json::from_string (R"([ 1, "1", [ 1 ], { "1": 1 }, true, null ])")));
+    CHECK_FALSE (validator.is_valid (json::from_string (R"([ 1, 2, 1.0 ])")));
+    CHECK_FALSE (validator.is_valid (json::from_string (R"([ { "a": 1, "b": 2 }, 0, { "b": 2, "a": 1 } ])")));
+        json::value
+    large = json::empty_array;
+    for (int i = 0; i < 50000; ++i)
+    {
+        large.push_back ({ { "id", i }, { "name", fmt::format ("item {}", i) } });
+    }
+    CHECK (validator.validate (large).first);
+    large.push_back ({ { "name", "item 123" }, { "id", 123.0 } });
+        auto
+    [valid, errors] = validator.validate (large);
+    CHECK_FALSE (valid);
+    CHECK (errors.at ("schemaLocation") == "#/uniqueItems");
+} // TEST_CASE("json_validator.hpp: uniqueItems")
+
+TEST_CASE("json_validator.hpp: enum")
+{
+        json::value
+    codes = json::empty_array;
+    for (int i = 0; i < 5000; ++i)
+    {
+        codes.push_back (fmt::format ("SKU-{}", i));
+    }
+    for (auto&& v: { "null", "false", "3", "-4.0", "2.5", "18446744073709551615", "[ 1, { \"a\": 2 } ]", R"({ "x": [], "y": 1 })" })
+    {
+        codes.push_back (json::from_string (v));
+    }
+        validator_t
+    validator;
+    validator.add_schema ({ { "enum", codes } }, "http://example.com/enum");
+    for (auto&& v: { R"("SKU-0")", R"("SKU-4999")", "null", "false", "3.0", "-4", "2.5", "18446744073709551615", "[ 1.0, { \"a\": 2 } ]", R"({ "y": 1, "x": [] })" })
+    {
+        CHECK_MESSAGE (validator.is_valid (json::from_string (v)), v);
+        CHECK_MESSAGE (validator.validate (json::from_string (v)).first, v);
+    }
+    for (auto&& v: { R"("SKU-5000")", R"("sku-1")", "true", "4", "2.25", "18446744073709551614", "[ { \"a\": 2 }, 1 ]", R"({ "x": [] })", "{}" })
+    {
+        CHECK_FALSE_MESSAGE (validator.is_valid (json::from_string (v)), v);
+        CHECK_FALSE_MESSAGE (validator.validate (json::from_string (v)).first, v);
+    }
+} // TEST_CASE("json_validator.hpp: enum")
+
+TEST_CASE("json_validator.hpp: discriminated unions")
+{
+        json::value
+    variants = json::empty_array;
+    for (int i = 0; i < 80; ++i)
+    {
+        variants.push_back ({
+              { "properties", {
+                    { "type", { { "const", fmt::format ("event-{}", i) } } }
+                  , { "payload", { { "type", i % 2 ? "string" : "integer" } } }
+              }}
+            , { "required", json::value::array_t { "type" } }
+        });
+    }
+        validator_t
+    validator;
+    validator.add_schema ({ { "oneOf", variants } }, "http://example.com/one-of");
+    validator.add_schema ({ { "anyOf", variants } }, "http://example.com/any-of");
+    for (auto&& uri: { "http://example.com/one-of", "http://example.com/any-of" })
+    {
+        CHECK (validator.is_valid (json::from_string (R"({ "type": "event-3", "payload": "x" })"), uri));
+        CHECK (validator.validate (json::from_string (R"({ "type": "event-42", "payload": 1 })"), uri).first);
+        CHECK_FALSE (validator.is_valid (json::from_string (R"({ "type": "event-3", "payload": 1 })"), uri));
+        CHECK_FALSE (validator.is_valid (json::from_string (R"({ "type": "event-80" })"), uri));
+        CHECK_FALSE (validator.is_valid (json::from_string (R"({ "type": 3 })"), uri));
+        CHECK_FALSE (validator.is_valid (json::from_string (R"({})"), uri));
+    }
+    // Not an object: every branch holds.
+    CHECK_FALSE (validator.is_valid (json::from_string ("1"), "http://example.com/one-of"));
+    CHECK (validator.is_valid (json::from_string ("1"), "http://example.com/any-of"));
+    // Only the candidate is reported.
+        auto
+    errors = validator.validate (
+          json::from_string (R"({ "type": "event-3", "payload": 1 })")
+        , "http://example.com/one-of"
+    ).second;
+    CHECK (errors.at ("errors").get_array ().size () == 1);
+    CHECK (errors.at ("errors").at (0).at ("schemaLocation") == "#/oneOf/3/properties/payload");
+} // TEST_CASE("json_validator.hpp: discriminated unions")
+
+TEST_CASE("json_validator.hpp: shared sub-schemas")
+{
+        validator_t
+    validator;
+        auto
+    document = [](std::string const& property)
+    {
+        return json::from_string (fmt::format (R"({{
+              "$defs": {{
+                  "count": {{ "type": "integer", "minimum": 0 }}
+                , "item": {{ "type": "object", "properties": {{ "n": {{ "type": "integer", "minimum": 0 }} }} }}
+              }}
+            , "type": "object"
+            , "properties": {{
+                  "{}": {{ "$ref": "#/$defs/count" }}
+                , "items": {{ "type": "array", "items": {{ "$ref": "#/$defs/item" }} }}
+              }}
+        }})", property));
+    };
+    validator.add_schema (document ("a"), "http://example.com/a");
+    validator.add_schema (document ("b"), "http://example.com/b");
+    // Registering an equal document again changes nothing.
+    validator.add_schema (document ("b"), "http://example.com/b");
+    CHECK (validator.is_valid (json::from_string (R"({ "a": "x", "b": 1 })"), "http://example.com/b"));
+    CHECK_FALSE (validator.is_valid (json::from_string (R"({ "a": 1, "b": -1 })"), "http://example.com/b"));
+    CHECK_FALSE (validator.is_valid (json::from_string (R"({ "a": -1 })"), "http://example.com/a"));
+    CHECK_FALSE (validator.is_valid (json::from_string (R"({ "items": [ { "n": -1 } ] })"), "http://example.com/b"));
+    // The sub-schemas of the second document are still reachable.
+    CHECK (validator.is_valid (json::from_string ("1"), "http://example.com/b#/$defs/count"));
+    CHECK_FALSE (validator.is_valid (json::from_string ("-1"), "http://example.com/b#/$defs/item/properties/n"));
+        auto
+    errors = validator.validate (json::from_string (R"({ "b": -1 })"), "http://example.com/b").second;
+    CHECK (errors.at ("schemaLocation") == "#/properties/b");
+} // TEST_CASE("json_validator.hpp: shared sub-schemas")
+
+TEST_CASE("json_validator.hpp: the meta-schema is shared")
+{
+        validator_t
+    first;
+    CHECK (first.validate_schema (json::from_string (R"({ "type": "string" })")).first);
+    CHECK_FALSE (first.validate_schema (json::from_string (R"({ "type": 1 })")).first);
+        validator_t
+    second;
+    second.add_schema (
+          json::from_string (R"({
+              "properties": { "schema": { "$ref": "http://json-schema.org/draft-07/schema#" } }
+          })")
+        , "http://example.com/wrapper"
+    );
+    CHECK (second.is_valid (json::from_string (R"({ "schema": { "minimum": 1 } })")));
+    CHECK_FALSE (second.is_valid (json::from_string (R"({ "schema": { "minimum": "1" } })")));
+    CHECK_FALSE (second.is_valid (
+          json::from_string ("[ 1, 2 ]")
+        , "http://json-schema.org/draft-07/schema#/definitions/stringArray"
+    ));
+    CHECK (first.is_valid (json::from_string ("{}"), "http://json-schema.org/draft-07/schema"));
+} // TEST_CASE("json_validator.hpp: the meta-schema is shared")
+
+TEST_CASE("json_validator.hpp: a validator is shared between threads")
+{
+        validator_t
+    validator;
+    validator.add_schema (
+          json::from_string (R"({ 
+              "type": "array"
+            , "items": { "type": "object", "required": [ "id" ], "properties": { "id": { "type": "integer" } } } 
+          })")
+        , "http://example.com/threads"
+    );
+        const auto
+    valid = json::from_string (R"([ { "id": 1 }, { "id": 2 } ])");
+        const auto
+    invalid = json::from_string (R"([ { "id": 1 }, { "id": "2" } ])");
+        const auto&
+    shared = validator;
+        std::vector <int>
+    failures (4, 0);
+        std::vector <std::thread>
+    threads;
+    for (std::size_t t = 0; t < failures.size (); ++t)
+    {
+        threads.emplace_back ([&, t]
+        {
+                validation_context_t
+            context;
+            for (int i = 0; i < 200; ++i)
+            {
+                if (
+                       !shared.evaluate (valid, context).valid ()
+                    || shared.evaluate (invalid, context).valid ()
+                    || !shared.is_valid (valid)
+                    || shared.validate (invalid).first
+                ){
+                    ++failures[t];
+                }
+            }
+        });
+    }
+    for (auto&& thread: threads)
+    {
+        thread.join ();
+    }
+    CHECK (failures == std::vector <int> (failures.size (), 0));
+} // TEST_CASE("json_validator.hpp: a validator is shared between threads")
+
+TEST_CASE("json_validator.hpp: validate_batch")
+{
+        validator_t
+    validator;
+    validator.add_schema (
+          json::from_string (R"({ "type": "object", "properties": { "n": { "maximum": 900 } } })")
+        , "http://example.com/batch"
+    );
+        std::vector <json::value>
+    instances;
+    for (int i = 0; i < 1000; ++i)
+    {
+        instances.push_back ({ { "n", i } });
+    }
+    for (auto&& options: { 
+          batch_options_t { 1, 0, true } 
+        , batch_options_t { 4, 7, true } 
+        , batch_options_t { 3, 0, false } 
+    }){
+            auto
+        result = validator.validate_batch (
+              std::begin (instances)
+            , std::end (instances)
+            , "http://example.com/batch"
+            , options
+        );
+        REQUIRE (result.valid.size () == instances.size ());
+        for (std::size_t i = 0; i < instances.size (); ++i)
+        {
+            CHECK (result.valid[i] == (i <= 900));
+        }
+        if (options.collect_errors)
+        {
+            REQUIRE (result.errors.size () == 99);
+            CHECK (result.errors.front ().first == 901);
+            CHECK (result.errors.back ().first == 999);
+            CHECK (result.errors.front ().second == validator.validate (instances[901]).second);
+        }
+        else
+        {
+            CHECK (result.errors.empty ());
+        }
+    }
+    // Concurrent batches share the pool.
+        std::vector <std::size_t>
+    invalid (4);
+        std::vector <std::thread>
+    threads;
+    for (std::size_t t = 0; t < invalid.size (); ++t)
+    {
+        threads.emplace_back ([&, t]
+        {
+            for (auto repeat = 0; repeat < 10; ++repeat)
+            {
+                    auto
+                result = validator.validate_batch (
+                      std::begin (instances)
+                    , std::end (instances)
+                    , "http://example.com/batch"
+                    , batch_options_t { 4, 0, false }
+                );
+                invalid[t] += std::count (std::begin (result.valid), std::end (result.valid), 0);
+            }
+        });
+    }
+    for (auto&& thread: threads)
+    {
+        thread.join ();
+    }
+    CHECK (invalid == std::vector <std::size_t> (invalid.size (), 990));
+} // TEST_CASE("json_validator.hpp: validate_batch")
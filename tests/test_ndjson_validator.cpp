@@ -0,0 +1,78 @@
+#include <doctest/doctest.h>
+#include "../include/calculisto/json_validator/ndjson_validator.hpp"
+    using namespace calculisto::json_validator;
+    namespace json = tao::json;
+#include <fstream>
+
+TEST_CASE("ndjson_validator.hpp")
+{
+        validator_t
+    validator;
+    validator.add_schema (
+          json::from_string (R"({ "type": "object", "required": [ "id" ] })")
+        , "http://example.com/ndjson"
+    );
+        std::string
+    data;
+        std::vector <std::size_t>
+    expected;
+    for (std::size_t line = 1; line <= 5000; ++line)
+    {
+        if (line % 1000 == 0)
+        {
+            data += "\r\n";
+            continue;
+        }
+        if (line % 97 == 0)
+        {
+            data += R"({ "name": "no id" })" "\n";
+            expected.push_back (line);
+            continue;
+        }
+        if (line == 4321)
+        {
+            data += "{ not json\n";
+            expected.push_back (line);
+            continue;
+        }
+        data += fmt::format (R"({{ "id": {} }})" "\n", line);
+    }
+    for (auto&& options: { 
+          ndjson_options_t { 1, 1 << 20, true }
+        , ndjson_options_t { 4, 100, true }
+        , ndjson_options_t { 3, 1000, false }
+    }){
+            ndjson_validator_t
+        ndjson { validator, "http://example.com/ndjson", options };
+            std::vector <std::size_t>
+        lines;
+            auto
+        summary = ndjson.validate (data, [&](std::size_t line, json::value const& errors)
+        {
+            lines.push_back (line);
+            // Parse errors are reported either way.
+            CHECK ((errors.is_null () != options.collect_errors || line == 4321));
+        });
+        CHECK (lines == expected);
+        CHECK (summary.documents == 4995);
+        CHECK (summary.invalid == expected.size ());
+    }
+        auto
+    path = std::filesystem::temp_directory_path () / "test_ndjson_validator.ndjson";
+    std::ofstream { path } << data;
+        std::vector <std::size_t>
+    lines;
+        auto
+    summary = ndjson_validator_t { validator, "http://example.com/ndjson" }.validate_file (
+          path
+        , [&](std::size_t line, json::value const&) { lines.push_back (line); }
+    );
+    std::filesystem::remove (path);
+    CHECK (lines == expected);
+    CHECK (summary.invalid == expected.size ());
+    // An exception thrown by the sink stops the workers, and is rethrown.
+    CHECK_THROWS (ndjson_validator_t { validator, "http://example.com/ndjson", { 4, 100, true } }.validate (
+          data
+        , [](std::size_t, json::value const&) { throw std::runtime_error { "sink" }; }
+    ));
+} // TEST_CASE("ndjson_validator.hpp")
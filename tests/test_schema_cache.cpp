@@ -0,0 +1,84 @@
+#include <doctest/doctest.h>
+#include "../include/calculisto/json_validator/schema_cache.hpp"
+    using namespace calculisto::json_validator;
+    namespace json = tao::json;
+#include <fstream>
+
+TEST_CASE("schema_cache.hpp")
+{
+        auto const
+    directory = std::filesystem::temp_directory_path () / fmt::format ("schema_cache_{}", ::getpid ());
+    std::filesystem::create_directories (directory);
+        auto
+    write = [](std::filesystem::path const& path, std::string const& text)
+    {
+        std::ofstream { path } << text;
+    };
+    write (directory / "item.json", R"({
+          "type": "object"
+        , "required": [ "id" ]
+        , "properties": {
+              "id": { "type": "integer", "minimum": 0 }
+            , "name": { "type": "string", "pattern": "^[A-Z]" }
+            , "size": { "$ref": "http://json-schema.org/draft-07/schema#/definitions/nonNegativeInteger" }
+          }
+    })");
+    write (directory / "list.json", R"({
+          "type": "array"
+        , "items": { "$ref": "http://example.com/item" }
+        , "definitions": { "id": { "type": "integer", "minimum": 0 } }
+    })");
+        std::vector <schema_file_t> const
+    files {
+          { directory / "item.json", "http://example.com/item" }
+        , { directory / "list.json", "http://example.com/list" }
+    };
+        auto const
+    cache = directory / "schemas.cache";
+        std::vector <json::value> const
+    instances {
+          json::from_string (R"([ { "id": 1, "name": "Ab", "size": 2 } ])")
+        , json::from_string (R"([ { "id": -1 } ])")
+        , json::from_string (R"([ { "id": 1, "name": "ab" } ])")
+        , json::from_string (R"([ { "id": 1, "size": -2 } ])")
+        , json::from_string (R"([ { "name": "Ab" } ])")
+    };
+        validator_t
+    built;
+    CHECK_FALSE (schema_cache_t::add_schema_files (built, files, cache));
+    CHECK (std::filesystem::exists (cache));
+        validator_t
+    loaded;
+    CHECK (schema_cache_t::add_schema_files (loaded, files, cache));
+    for (auto&& instance: instances)
+    {
+        CHECK (loaded.validate (instance, "http://example.com/list") == built.validate (instance, "http://example.com/list"));
+        CHECK (loaded.validate (instance) == built.validate (instance));
+    }
+    CHECK (loaded.is_valid (instances[0], "http://example.com/list"));
+    CHECK_FALSE (loaded.is_valid (instances[1], "http://example.com/list"));
+    // More schemas can be registered after a load.
+    loaded.add_schema (json::from_string (R"({ "$ref": "http://example.com/item#/properties/id" })"), "http://example.com/id");
+    CHECK (loaded.is_valid (json::value { 3 }, "http://example.com/id"));
+    CHECK_FALSE (loaded.is_valid (json::value { -3 }, "http://example.com/id"));
+    // Only an empty validator can be loaded into.
+    CHECK_THROWS (schema_cache_t::add_schema_files (loaded, files, cache));
+    // A change of a source file invalidates the cache.
+    write (directory / "item.json", R"({ "type": "object", "required": [ "name" ] })");
+        validator_t
+    changed;
+    CHECK_FALSE (schema_cache_t::add_schema_files (changed, files, cache));
+    CHECK (changed.is_valid (instances[0], "http://example.com/list"));
+    CHECK_FALSE (changed.is_valid (json::from_string (R"([ { "id": 1 } ])"), "http://example.com/list"));
+        validator_t
+    reloaded;
+    CHECK (schema_cache_t::add_schema_files (reloaded, files, cache));
+    CHECK_FALSE (reloaded.is_valid (json::from_string (R"([ { "id": 1 } ])"), "http://example.com/list"));
+    // A damaged cache is rebuilt.
+    std::filesystem::resize_file (cache, std::filesystem::file_size (cache) / 2);
+        validator_t
+    repaired;
+    CHECK_FALSE (schema_cache_t::add_schema_files (repaired, files, cache));
+    CHECK (repaired.is_valid (json::from_string (R"([ { "name": "x" } ])"), "http://example.com/list"));
+    std::filesystem::remove_all (directory);
+}
@@ -0,0 +1,137 @@
+#include <doctest/doctest.h>
+#include "../include/calculisto/json_validator/static_validator.hpp"
+    using namespace calculisto::json_validator;
+    namespace json = tao::json;
+
+    constexpr char
+records_schema[] = R"({
+      "$id": "http://example.com/records"
+    , "type": "array"
+    , "items": { "$ref": "#/definitions/record" }
+    , "maxItems": 4
+    , "uniqueItems": true
+    , "definitions": {
+          "record": {
+              "type": "object"
+            , "required": [ "id", "kind" ]
+            , "properties": {
+                  "id": { "type": "integer", "minimum": 0, "exclusiveMaximum": 1e3 }
+                , "kind": { "enum": [ "a", "b", { "c": [ 1, null ] } ] }
+                , "name": { "type": "string", "minLength": 1, "maxLength": 3, "format": "hostname" }
+                , "ratio": { "type": "number", "multipleOf": 0.5 }
+                , "tags": {
+                      "type": "array"
+                    , "items": [ { "const": "first" } ]
+                    , "additionalItems": { "type": "string" }
+                    , "contains": { "const": "xé" }
+                  }
+                , "next": { "$ref": "#/definitions/record" }
+              }
+            , "additionalProperties": false
+            , "dependencies": { "ratio": [ "name" ] }
+            , "if": { "properties": { "kind": { "const": "b" } } }
+            , "then": { "required": [ "name" ] }
+            , "oneOf": [ { "required": [ "name" ] }, { "not": { "required": [ "name" ] } } ]
+          }
+      }
+})";
+
+TEST_CASE("static_validator.hpp")
+{
+        using
+    records = static_validator_t <records_schema>;
+        validator_t
+    dynamic;
+    dynamic.add_schema (json::from_string (records_schema), "http://example.com/records");
+        std::vector <json::value> const
+    instances {
+          json::from_string (R"([])")
+        , json::from_string (R"([ { "id": 1, "kind": "a" } ])")
+        , json::from_string (R"([ { "id": 1, "kind": "b", "name": "abc", "ratio": 1.5 } ])")
+        , json::from_string (R"([ { "id": 1, "kind": { "c": [ 1, null ] } } ])")
+        , json::from_string (R"([ { "id": 1, "kind": { "c": [ 1.0, null ] } } ])")
+        , json::from_string (R"([ { "id": 1, "kind": { "c": [ 1 ] } } ])")
+        , json::from_string (R"([ { "id": 1, "kind": "b" } ])")
+        , json::from_string (R"([ { "id": 1, "kind": "c" } ])")
+        , json::from_string (R"([ { "id": -1, "kind": "a" } ])")
+        , json::from_string (R"([ { "id": 999, "kind": "a" } ])")
+        , json::from_string (R"([ { "id": 1000, "kind": "a" } ])")
+        , json::from_string (R"([ { "id": 1.5, "kind": "a" } ])")
+        , json::from_string (R"([ { "id": 1, "kind": "a", "name": "" } ])")
+        , json::from_string (R"([ { "id": 1, "kind": "a", "name": "abcd" } ])")
+        , json::from_string (R"([ { "id": 1, "kind": "a", "name": "ééé" } ])")
+        , json::from_string (R"([ { "id": 1, "kind": "a", "name": "éééé" } ])")
+        , json::from_string (R"([ { "id": 1, "kind": "a", "name": "ab", "ratio": 0.7 } ])")
+        , json::from_string (R"([ { "id": 1, "kind": "a", "ratio": 2 } ])")
+        , json::from_string (R"([ { "id": 1, "kind": "a", "other": 2 } ])")
+        , json::from_string (R"([ { "id": 1, "kind": "a", "tags": [ "first", "xé" ] } ])")
+        , json::from_string (R"([ { "id": 1, "kind": "a", "tags": [ "first", "y" ] } ])")
+        , json::from_string (R"([ { "id": 1, "kind": "a", "tags": [ "second", "xé" ] } ])")
+        , json::from_string (R"([ { "id": 1, "kind": "a", "tags": [ "first", "xé", 3 ] } ])")
+        , json::from_string (R"([ { "id": 1, "kind": "a", "next": { "id": 2, "kind": "a" } } ])")
+        , json::from_string (R"([ { "id": 1, "kind": "a", "next": { "id": 2 } } ])")
+        , json::from_string (R"([ { "id": 1, "kind": "a" }, { "id": 1, "kind": "a" } ])")
+        , json::from_string (R"([ {}, {}, {}, {}, {} ])")
+        , json::from_string (R"({ "id": 1, "kind": "a" })")
+    };
+    for (auto&& instance: instances)
+    {
+        CHECK_MESSAGE (records::is_valid (instance) == dynamic.is_valid (instance), json::to_string (instance));
+        CHECK_MESSAGE (records::validate (instance) == dynamic.validate (instance), json::to_string (instance));
+    }
+    CHECK (records::is_valid (instances[1]));
+    CHECK_FALSE (records::is_valid (instances[8]));
+    // Boolean schemas, and references to the root.
+    CHECK (static_validator_t <"true">::is_valid (json::value { 1 }));
+    CHECK_FALSE (static_validator_t <"false">::is_valid (json::value { 1 }));
+        using
+    tree = static_validator_t <R"({
+          "type": "object"
+        , "properties": { "children": { "type": "array", "items": { "$ref": "#" } } }
+        , "propertyNames": { "maxLength": 8 }
+    })">;
+    CHECK (tree::is_valid (json::from_string (R"({ "children": [ { "children": [] } ] })")));
+    CHECK_FALSE (tree::is_valid (json::from_string (R"({ "children": [ { "children": 1 } ] })")));
+    CHECK_FALSE (tree::is_valid (json::from_string (R"({ "children": [ { "descendants": [] } ] })")));
+    // Large enums of strings or of integers are looked up in sorted tables.
+        constexpr char
+    codes_schema[] = R"({
+          "properties": {
+              "country": { "enum": [ "fr", "de", "it", "es", "pt", "be", "nl", "lu", "at", "ch" ] }
+            , "code": { "enum": [ 75, 13, 69, 31, 6, 44, 67, 33, 34, 35, -1, 9007199254740993 ] }
+            , "mixed": { "enum": [ "a", 1, "b", 2, "c", 3, "d", 4, null ] }
+          }
+    })";
+        using
+    codes = static_validator_t <codes_schema>;
+        constexpr auto const&
+    codes_document = detail::static_document <codes_schema>;
+        constexpr auto
+    country = codes_document.member (codes_document.member (codes_document.member (0, "properties"), "country"), "enum");
+        constexpr auto
+    mixed = codes_document.member (codes_document.member (codes_document.member (0, "properties"), "mixed"), "enum");
+    static_assert (detail::static_enum_kind <codes_schema, country> () == json::type::STRING);
+    static_assert (detail::static_enum_kind <codes_schema, mixed> () == json::type::NULL_);
+    static_assert (std::is_sorted (
+          detail::static_enum_table <codes_schema, country, std::string_view>.begin ()
+        , detail::static_enum_table <codes_schema, country, std::string_view>.end ()
+    ));
+    dynamic.add_schema (json::from_string (codes_schema), "http://example.com/codes");
+    for (auto&& text: {
+          R"({ "country": "fr" })", R"({ "country": "ch" })", R"({ "country": "uk" })", R"({ "country": 1 })"
+        , R"({ "code": 75 })", R"({ "code": 75.0 })", R"({ "code": 75.5 })", R"({ "code": -1 })", R"({ "code": 0 })"
+        , R"({ "code": 9007199254740993 })", R"({ "code": 9007199254740992 })", R"({ "code": "75" })"
+        , R"({ "mixed": "d" })", R"({ "mixed": 4.0 })", R"({ "mixed": null })", R"({ "mixed": "e" })"
+    }){
+            auto
+        instance = json::from_string (text);
+        CHECK_MESSAGE (codes::is_valid (instance) == dynamic.is_valid (instance, "http://example.com/codes"), text);
+    }
+    CHECK (codes::is_valid (json::from_string (R"({ "country": "lu", "code": 6 })")));
+    CHECK_FALSE (codes::is_valid (json::from_string (R"({ "code": 7 })")));
+    // Numbers of the schema are read as tao::json reads them.
+    static_assert (detail::static_document <"[ -9223372036854775808, 18446744073709551615, 0.1, -2.5e-3 ]">.nodes[1].number.signed_value == std::numeric_limits <std::int64_t>::min ());
+    static_assert (detail::static_document <"[ -9223372036854775808, 18446744073709551615, 0.1, -2.5e-3 ]">.nodes[2].number.unsigned_value == std::numeric_limits <std::uint64_t>::max ());
+    static_assert (detail::static_document <"[ -9223372036854775808, 18446744073709551615, 0.1, -2.5e-3 ]">.nodes[3].number.double_value == 0.1);
+    static_assert (detail::static_document <"[ -9223372036854775808, 18446744073709551615, 0.1, -2.5e-3 ]">.nodes[4].number.double_value == -2.5e-3);
+}
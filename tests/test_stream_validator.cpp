@@ -0,0 +1,80 @@
+#include <doctest/doctest.h>
+#include "../include/calculisto/json_validator/stream_validator.hpp"
+    using namespace calculisto::json_validator;
+    namespace json = tao::json;
+
+    bool
+stream_is_valid (validator_t& validator, std::string const& document, std::string const& schema_uri = "")
+{
+        stream_validator_t
+    consumer { validator, schema_uri };
+    json::events::from_string (consumer, document);
+    return consumer.valid ();
+}
+
+TEST_CASE("stream_validator.hpp")
+{
+        validator_t
+    validator;
+    validator.add_schema (
+          json::from_string (R"({
+              "definitions": {
+                  "point": {
+                      "type": "object"
+                    , "properties": { "x": { "type": "number" }, "y": { "type": "number" } }
+                    , "required": [ "x", "y" ]
+                    , "additionalProperties": false
+                  }
+              }
+            , "type": "object"
+            , "properties": {
+                  "name": { "type": "string", "maxLength": 8 }
+                , "points": { "type": "array", "items": { "$ref": "#/definitions/point" }, "maxItems": 3 }
+                , "tags": { "type": "array", "uniqueItems": true }
+                , "kind": { "enum": [ "a", "b" ] }
+                , "extra": { "anyOf": [ { "type": "integer" }, { "type": "array", "items": { "type": "string" } } ] }
+              }
+            , "patternProperties": { "^x-": { "type": "boolean" } }
+            , "dependentRequired": { "name": [ "kind" ] }
+          })")
+        , "http://example.com/stream"
+    );
+        const char*
+    documents[] = {
+          R"({})"
+        , R"({ "name": "short", "kind": "a" })"
+        , R"({ "name": "far too long", "kind": "a" })"
+        , R"({ "name": "short" })"
+        , R"({ "points": [ { "x": 1, "y": 2.5 }, { "x": 0, "y": 0 } ] })"
+        , R"({ "points": [ { "x": 1 } ] })"
+        , R"({ "points": [ { "x": 1, "y": 2, "z": 3 } ] })"
+        , R"({ "points": [ {"x":1,"y":1}, {"x":1,"y":1}, {"x":1,"y":1}, {"x":1,"y":1} ] })"
+        , R"({ "tags": [ 1, [ 2 ], { "a": 3 } ] })"
+        , R"({ "tags": [ { "a": 3 }, { "a": 3 } ] })"
+        , R"({ "kind": "c" })"
+        , R"({ "extra": 3 })"
+        , R"({ "extra": [ "a", "b" ] })"
+        , R"({ "extra": [ "a", 1 ] })"
+        , R"({ "x-flag": true })"
+        , R"({ "x-flag": 1 })"
+        , R"([])"
+    };
+    for (auto&& document: documents)
+    {
+        CHECK_MESSAGE (
+              stream_is_valid (validator, document) == validator.is_valid (json::from_string (document))
+            , document
+        );
+    }
+    // The meta-schema, on itself.
+    CHECK (stream_is_valid (
+          validator
+        , detail::draft_07_schema
+        , "http://json-schema.org/draft-07/schema"
+    ));
+    CHECK_FALSE (stream_is_valid (
+          validator
+        , R"({ "type": 12 })"
+        , "http://json-schema.org/draft-07/schema"
+    ));
+} // TEST_CASE("stream_validator.hpp")
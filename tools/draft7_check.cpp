@@ -0,0 +1,49 @@
+// Runs the draft7 test suite through the generated code, and checks that it
+// answers like validator_t.
+#include "draft7_generated.hpp"
+#include "draft7_suite.hpp"
+    using namespace calculisto::json_validator;
+#include <iostream>
+
+    int
+main ()
+{
+        std::size_t
+    tests = 0;
+        std::size_t
+    disagreements = 0;
+    for (auto&& suite: generated_suites)
+    {
+            auto const
+        test_file = tao::json::from_file (draft7_path / suite.file);
+            auto const&
+        test_suite = test_file.get_array ()[suite.index];
+            validator_t
+        validator;
+        for (auto&& [document, uri]: suite_documents (suite.file, test_suite))
+        {
+            validator.add_schema (document, uri);
+        }
+        for (auto&& test: test_suite.at ("tests").get_array ())
+        {
+            ++tests;
+                auto const&
+            data = test.at ("data");
+            if (
+                   suite.is_valid (data) != validator.is_valid (data)
+                || suite.validate (data) != validator.validate (data)
+            ){
+                ++disagreements;
+                std::cerr << fmt::format (
+                      "{} #{}: {}: the generated code disagrees on {}\n"
+                    , suite.file
+                    , suite.index
+                    , test.at ("description").get_string ()
+                    , tao::json::to_string (data)
+                );
+            }
+        }
+    }
+    std::cout << fmt::format ("{} suites, {} tests, {} disagreements\n", std::size (generated_suites), tests, disagreements);
+    return disagreements != 0;
+}
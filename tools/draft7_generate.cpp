@@ -0,0 +1,78 @@
+// Generates the code of every schema of the draft7 test suite, in one
+// header, with a table of the suites for draft7_check.
+#include "../include/calculisto/json_validator/code_generator.hpp"
+#include "draft7_suite.hpp"
+    using namespace calculisto::json_validator;
+#include <iostream>
+    namespace fs = std::filesystem;
+
+    int
+main ()
+{
+        std::vector <fs::path>
+    files;
+    for (auto&& p: fs::directory_iterator (draft7_path))
+    {
+        if (p.is_regular_file ())
+        {
+            files.push_back (p.path ());
+        }
+    }
+    std::sort (files.begin (), files.end ());
+        std::string
+    table;
+        std::size_t
+    count = 0;
+    std::cout << "#pragma once\n";
+    for (auto&& file: files)
+    {
+            auto const
+        test_file = tao::json::from_file (file);
+        for (std::size_t i = 0; i < test_file.get_array ().size (); ++i)
+        {
+            try
+            {
+                    code_generator_t
+                generator {
+                      suite_documents (file, test_file.get_array ()[i])
+                    , "http://example.com/dummy"
+                    , fmt::format ("suite_{}", count)
+                };
+                std::cout << generator.generate ();
+            }
+            catch (std::exception const& e)
+            {
+                std::cerr << fmt::format ("{} #{}: skipped, {}\n", file.filename ().native (), i, e.what ());
+                continue;
+            }
+            table += fmt::format (
+                  "    {{ {}, {}, &suite_{}::is_valid, &suite_{}::validate }},\n"
+                , detail::cpp_literal (file.filename ().native ())
+                , i
+                , count
+                , count
+            );
+            ++count;
+        }
+    }
+    std::cout << fmt::format (R"(
+    using namespace std::literals;
+
+    struct
+generated_suite_t
+{{
+        std::string_view
+    file;
+        std::size_t
+    index;
+        bool
+    (*is_valid) (calculisto::json_validator::json_t const&);
+        std::pair <bool, calculisto::json_validator::json_t>
+    (*validate) (calculisto::json_validator::json_t const&);
+}};
+
+    inline const generated_suite_t
+generated_suites[] = {{
+{}}};
+)", table);
+}
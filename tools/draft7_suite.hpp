@@ -0,0 +1,52 @@
+// The draft7 test suite, read from the same place as in the tests.
+#pragma once
+#include "../include/calculisto/json_validator/json_validator.hpp"
+#include <filesystem>
+
+    inline auto const
+json_schema_path = std::filesystem::path { "../../../external/json-schema-org/" };
+
+    inline auto const
+draft7_path = json_schema_path / "json-schema-test-suite/tests/draft7";
+
+// The remote schemas of refRemote.json, with their URIs.
+    inline void
+remote_schemas (
+      std::filesystem::path const&                                                     root
+    , std::filesystem::path const&                                                     relative
+    , std::vector <std::pair <calculisto::json_validator::json_t, std::string>>&       documents
+){
+    for (auto&& r: std::filesystem::directory_iterator (root / relative))
+    {
+        if (r.is_directory ())
+        {
+            remote_schemas (root, relative / r.path ().filename (), documents);
+        }
+        if (!r.is_regular_file ())
+        {
+            continue;
+        }
+            auto const
+        filename = relative / r.path ().filename ();
+        documents.emplace_back (
+              tao::json::from_file (root / filename)
+            , "http://localhost:1234/" + filename.native ()
+        );
+    }
+}
+
+// The documents of a test suite: its schema, registered last as
+// "http://example.com/dummy", after the remote schemas it needs.
+    inline auto
+suite_documents (std::filesystem::path const& file, calculisto::json_validator::json_t const& test_suite)
+    -> std::vector <std::pair <calculisto::json_validator::json_t, std::string>>
+{
+        std::vector <std::pair <calculisto::json_validator::json_t, std::string>>
+    documents;
+    if (file.filename () == "refRemote.json")
+    {
+        remote_schemas (json_schema_path / "json-schema-test-suite/remotes", "", documents);
+    }
+    documents.emplace_back (test_suite.at ("schema"), "http://example.com/dummy");
+    return documents;
+}
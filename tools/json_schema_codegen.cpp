@@ -0,0 +1,36 @@
+// Generates a header of straight-line validation code for a schema:
+//
+//     json_schema_codegen NAMESPACE FILE URI [FILE URI]... > schema.hpp
+//
+// The documents are registered in order, each under its URI. The header
+// validates against the first one.
+#include "../include/calculisto/json_validator/code_generator.hpp"
+    using namespace calculisto::json_validator;
+#include <iostream>
+
+    int
+main (int argc, char* argv[])
+{
+    if (argc < 4 || argc % 2 != 0)
+    {
+        std::cerr << "Usage: " << argv[0] << " NAMESPACE FILE URI [FILE URI]...\n";
+        return 2;
+    }
+    try
+    {
+            std::vector <std::pair <json_t, std::string>>
+        documents;
+        for (int i = 2; i < argc; i += 2)
+        {
+            documents.emplace_back (tao::json::from_file (argv[i]), argv[i + 1]);
+        }
+            code_generator_t
+        generator { documents, argv[3], argv[1] };
+        std::cout << generator.generate ();
+    }
+    catch (std::exception const& e)
+    {
+        std::cerr << argv[0] << ": " << e.what () << '\n';
+        return 1;
+    }
+}